@@ -2,9 +2,34 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <sstream>
+#include <iterator>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <limits>
 
 #include "optional.h"
 #include "vector.h"
+#include "arena.h"
+#include "remap_allocator.h"
+#include "stable_vector.h"
+#include "huge_page_allocator.h"
+#include "aligned_allocator.h"
+#include "small_vector.h"
+#include "concurrent_vector.h"
+#include "segmented_vector.h"
+#include "parallel_algorithms.h"
+#include "work_stealing.h"
+#include "simd.h"
+#include "soa_vector.h"
+#include "cow_vector.h"
+#include "persistent_vector.h"
+#include "bit_vector.h"
+#include "packed_int_vector.h"
+#include "vector_io.h"
 
 struct C {
     C() noexcept {
@@ -2856,4 +2881,2574 @@ void TestRefQualifiedMethodOverloading2() {
         opt.Value().Update();
         assert(C3::const_lvalue_call_count == 1);
     }
+}
+
+// allocator tests
+
+namespace {
+
+    // memory_resource counting requests passed to upstream
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        size_t bytes_in_use = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            bytes_in_use += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            ++deallocations;
+            bytes_in_use -= bytes;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+}  // namespace
+
+void TestPmrVector() {
+    const size_t SIZE = 100;
+    {
+        CountingResource resource;
+        {
+            pmr::Vector<int> v(&resource);
+            assert(v.GetAllocator().resource() == &resource);
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.PushBack(static_cast<int>(i));
+            }
+            assert(resource.allocations > 0);
+            assert(resource.bytes_in_use == v.Capacity() * sizeof(int));
+
+            // copy asks select_on_container_copy_construction - default resource
+            pmr::Vector<int> v_copy(v);
+            assert(v_copy.GetAllocator().resource() == std::pmr::get_default_resource());
+            assert(v_copy[SIZE - 1] == static_cast<int>(SIZE - 1));
+
+            // move steals buffer together with resource
+            const size_t allocations = resource.allocations;
+            pmr::Vector<int> v_moved(std::move(v));
+            assert(v_moved.GetAllocator().resource() == &resource);
+            assert(resource.allocations == allocations);
+            assert(v_moved.Size() == SIZE);
+        }
+        assert(resource.allocations == resource.deallocations);
+        assert(resource.bytes_in_use == 0);
+    }
+    {
+        // unequal resources, no propagation - move assignment moves elements
+        CountingResource lhs_resource;
+        CountingResource rhs_resource;
+        {
+            pmr::Vector<std::string> lhs(&lhs_resource);
+            pmr::Vector<std::string> rhs(SIZE, &rhs_resource);
+            rhs[0] = "first";
+            lhs = std::move(rhs);
+            assert(lhs.GetAllocator().resource() == &lhs_resource);
+            assert(lhs.Size() == SIZE);
+            assert(lhs[0] == "first");
+            assert(lhs_resource.bytes_in_use == lhs.Capacity() * sizeof(std::string));
+
+            // copy assignment keeps own resource as well
+            pmr::Vector<std::string> other(SIZE * 2, &rhs_resource);
+            lhs = other;
+            assert(lhs.GetAllocator().resource() == &lhs_resource);
+            assert(lhs.Size() == SIZE * 2);
+        }
+        assert(lhs_resource.bytes_in_use == 0);
+        assert(rhs_resource.bytes_in_use == 0);
+    }
+}
+
+void TestArenaVector() {
+    const size_t SIZE = 1000;
+    {
+        Arena arena(16 * 1024);
+        ArenaVector<int> v(&arena);
+        v.PushBack(0);
+        int* first = &v[0];
+        // vector sits on top of the arena - every growth is in place
+        for (size_t i = 1; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(&v[0] == first);
+        assert(v.Capacity() >= SIZE);
+        v.Reserve(SIZE * 2);
+        assert(&v[0] == first);
+        assert(v[SIZE - 1] == static_cast<int>(SIZE - 1));
+        assert(arena.BlockCount() == 1);
+    }
+    {
+        Arena arena(1024);
+        {
+            ArenaVector<std::string> a(&arena);
+            ArenaVector<std::string> b(&arena);
+            for (size_t i = 0; i < SIZE; ++i) {
+                a.PushBack(std::to_string(i));
+                b.EmplaceBack(i % 10, 'x');
+            }
+            assert(a[SIZE - 1] == std::to_string(SIZE - 1));
+            assert(b[SIZE - 1] == "xxxxxxxxx");
+            ArenaVector<std::string> c(a);
+            assert(c.GetAllocator() == a.GetAllocator());
+            assert(c[10] == "10");
+        }
+        const size_t blocks = arena.BlockCount();
+        assert(blocks > 1);
+        // blocks are reused after reset
+        for (int round = 0; round < 3; ++round) {
+            arena.Reset();
+            ArenaVector<int> v(&arena);
+            for (size_t i = 0; i < SIZE / 10; ++i) {
+                v.PushBack(static_cast<int>(i));
+            }
+            assert(arena.BlockCount() == blocks);
+        }
+    }
+}
+
+// small vector tests
+
+namespace {
+
+    // copyable, move may throw: strong guarantee needs copies on growth
+    struct ThrowingMove {
+        ThrowingMove() {
+            ++num_alive;
+        }
+        explicit ThrowingMove(int id) : id(id) {
+            ++num_alive;
+        }
+        ThrowingMove(const ThrowingMove& other) : id(other.id) {
+            if (other.throw_on_copy) {
+                throw std::runtime_error("Oops");
+            }
+            ++num_alive;
+        }
+        ThrowingMove(ThrowingMove&& other) : id(other.id) {
+            if (other.throw_on_move) {
+                throw std::runtime_error("Oops");
+            }
+            ++num_alive;
+        }
+        ThrowingMove& operator=(const ThrowingMove&) = default;
+        ThrowingMove& operator=(ThrowingMove&&) = default;
+        ~ThrowingMove() {
+            --num_alive;
+        }
+
+        bool throw_on_copy = false;
+        bool throw_on_move = false;
+        int id = 0;
+
+        static inline int num_alive = 0;
+    };
+
+}  // namespace
+
+void TestSmallVector() {
+    const size_t INLINE = 8;
+    const int ID = 42;
+    Obj3::ResetCounters();
+    {
+        SmallVector<Obj3, INLINE> v;
+        assert(v.IsInline());
+        assert(v.Capacity() == INLINE);
+        for (size_t i = 0; i < INLINE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.IsInline());
+        assert(Obj3::num_moved == 0);
+
+        // spill moves inline elements to heap
+        v.EmplaceBack(ID);
+        assert(!v.IsInline());
+        assert(v.Capacity() == INLINE * 2);
+        assert(Obj3::num_moved == INLINE);
+        assert(v[INLINE].id == ID);
+        assert(v[INLINE - 1].id == static_cast<int>(INLINE - 1));
+
+        v.Insert(v.begin(), v[INLINE]);
+        assert(v[0].id == ID);
+        v.Erase(v.begin());
+        assert(v[0].id == 0);
+        assert(Obj3::GetAliveObj3ectCount() == static_cast<int>(INLINE + 1));
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+    {
+        // spill and Resize follow growth policy
+        SmallVector<int, INLINE, OneAndHalfGrowth> v(INLINE);
+        v.PushBack(ID);
+        assert(v.Capacity() == INLINE + INLINE / 2);
+        v.Resize(v.Capacity() + 1);
+        assert(v.Capacity() == (INLINE + INLINE / 2) * 3 / 2);
+        assert(v[INLINE] == ID && v[INLINE + 1] == 0);
+    }
+    {
+        // Reserve, sized and copy constructors pad through Growth::Fit
+        using Padded = SmallVector<int, INLINE, SimdPaddedGrowth<64>>;
+        Padded v;
+        v.Reserve(INLINE + 1);
+        assert(!v.IsInline() && v.Capacity() == 16);
+        Padded sized(INLINE + 1);
+        assert(sized.Capacity() == 16);
+        Padded copy(sized);
+        assert(copy.Capacity() == 16 && copy.Size() == INLINE + 1);
+    }
+    Obj3::ResetCounters();
+    {
+        // copy on spill keeps source intact if copying throws
+        using OBJ = move_without_noexcept;
+        SmallVector<OBJ, INLINE> v(INLINE);
+        OBJ::Reset();
+        v.PushBack(OBJ{});
+        assert(OBJ::copy_ctor == INLINE);
+        assert(OBJ::move_ctor == 1u);
+
+        SmallVector<Obj3, INLINE> w(INLINE);
+        w[INLINE / 2].throw_on_copy = true;
+        try {
+            SmallVector<Obj3, INLINE> w_copy(w);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj3::GetAliveObj3ectCount() == static_cast<int>(INLINE));
+    }
+    Obj3::ResetCounters();
+    {
+        SmallVector<Obj3, INLINE> small(INLINE / 2);
+        SmallVector<Obj3, INLINE> large(INLINE * 4);
+        small[0].id = ID;
+        large.end()[-1].id = ID;
+
+        small.Swap(large);
+        assert(small.Size() == INLINE * 4 && !small.IsInline());
+        assert(large.Size() == INLINE / 2 && large.IsInline());
+        assert(small[INLINE * 4 - 1].id == ID);
+        assert(large[0].id == ID);
+
+        SmallVector<Obj3, INLINE> moved(std::move(large));
+        assert(large.Size() == 0);
+        assert(moved[0].id == ID);
+
+        large = small;
+        assert(large.Size() == INLINE * 4);
+        small.Resize(1);
+        assert(!small.IsInline());
+        assert(Obj3::GetAliveObj3ectCount() == static_cast<int>(INLINE * 4 + INLINE / 2 + 1));
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+    Obj3::ResetCounters();
+    {
+        // failed insertion at inline -> heap boundary leaves inline elements as they were
+        SmallVector<Obj3, INLINE> v;
+        for (size_t i = 0; i < INLINE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        auto unchanged = [&v](size_t size) {
+            if (v.Size() != size) {
+                return false;
+            }
+            for (size_t i = 0; i < size; ++i) {
+                if (v[i].id != static_cast<int>(i)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        Obj3 bad(ID);
+        bad.throw_on_copy = true;
+        try {
+            v.PushBack(bad);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.IsInline() && unchanged(INLINE));
+        try {
+            v.Insert(v.begin(), bad);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.IsInline() && unchanged(INLINE));
+        Obj3::default_construction_throw_countdown = 1;
+        try {
+            v.Emplace(v.begin() + INLINE / 2);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.IsInline() && unchanged(INLINE));
+        Obj3::default_construction_throw_countdown = 1;
+        try {
+            v.EmplaceBack();
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(v.IsInline() && unchanged(INLINE));
+        assert(Obj3::GetAliveObj3ectCount() == static_cast<int>(INLINE + 1));
+
+        // below capacity new value is built before elements shift
+        v.PopBack();
+        try {
+            v.Insert(v.begin(), bad);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(unchanged(INLINE - 1));
+        assert(Obj3::GetAliveObj3ectCount() == static_cast<int>(INLINE));
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+    {
+        // move may throw: spill copies elements, failed copy keeps them inline
+        SmallVector<ThrowingMove, INLINE> v;
+        for (size_t i = 0; i < INLINE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v[0].throw_on_move = true;
+        v.PushBack(ThrowingMove(ID));
+        assert(!v.IsInline() && v.Size() == INLINE + 1);
+        assert(v[0].id == 0 && v[INLINE].id == ID);
+
+        SmallVector<ThrowingMove, INLINE> w;
+        for (size_t i = 0; i < INLINE; ++i) {
+            w.EmplaceBack(static_cast<int>(i));
+        }
+        w[INLINE / 2].throw_on_copy = true;
+        try {
+            w.EmplaceBack(ID);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(w.IsInline() && w.Size() == INLINE);
+        for (size_t i = 0; i < INLINE; ++i) {
+            assert(w[i].id == static_cast<int>(i));
+        }
+
+        // throwing move of last element while shifting leaves vector unchanged
+        w.PopBack();
+        w[INLINE / 2].throw_on_copy = false;
+        w[INLINE - 2].throw_on_move = true;
+        try {
+            w.Insert(w.begin(), ThrowingMove(ID));
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(w.Size() == INLINE - 1);
+        for (size_t i = 0; i < INLINE - 1; ++i) {
+            assert(w[i].id == static_cast<int>(i));
+        }
+        assert(ThrowingMove::num_alive == static_cast<int>(INLINE + 1 + INLINE - 1));
+    }
+    assert(ThrowingMove::num_alive == 0);
+}
+
+// relocation tests
+
+namespace {
+
+    // counts calls, but declares itself relocatable by memcpy
+    struct Handle {
+        Handle() {
+            ++num_alive;
+        }
+        explicit Handle(int id) : id(id) {
+            ++num_alive;
+        }
+        Handle(const Handle& other) : id(other.id) {
+            ++num_alive;
+            ++num_copied;
+        }
+        Handle(Handle&& other) noexcept : id(other.id) {
+            ++num_alive;
+            ++num_moved;
+        }
+        Handle& operator=(const Handle&) = default;
+        Handle& operator=(Handle&&) = default;
+        ~Handle() {
+            --num_alive;
+        }
+
+        int id = 0;
+
+        static inline int num_alive = 0;
+        static inline int num_copied = 0;
+        static inline int num_moved = 0;
+    };
+
+}  // namespace
+
+template <>
+struct IsTriviallyRelocatable<Handle> : std::true_type {};
+
+void TestTriviallyRelocatable() {
+    static_assert(is_trivially_relocatable_v<int>);
+    static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(!is_trivially_relocatable_v<Obj3>);
+
+    const int SIZE = 100;
+    {
+        Vector<Handle> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Reserve(SIZE * 4);
+        // growth never touched move constructor
+        assert(Handle::num_moved == 0);
+        assert(Handle::num_alive == SIZE);
+
+        v.Emplace(v.begin(), -1);
+        v.Insert(v.begin() + SIZE / 2, Handle(-2));
+        assert(v[0].id == -1);
+        assert(v[SIZE / 2].id == -2);
+        assert(v[SIZE / 2 + 1].id == SIZE / 2 - 1);
+        assert(v[SIZE + 1].id == SIZE - 1);
+
+        v.Erase(v.begin() + SIZE / 2);
+        v.Erase(v.begin());
+        for (int i = 0; i < SIZE; ++i) {
+            assert(v[i].id == i);
+        }
+        assert(Handle::num_alive == SIZE);
+
+        v.Resize(SIZE * 2);
+        assert(v[SIZE * 2 - 1].id == 0);
+        assert(Handle::num_alive == SIZE * 2);
+    }
+    assert(Handle::num_alive == 0);
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.Insert(v.begin() + 1, std::make_unique<int>(-1));
+        v.Erase(v.begin());
+        assert(*v[0] == -1);
+        assert(*v[SIZE - 1] == SIZE - 1);
+
+        SmallVector<std::unique_ptr<int>, 4> sv;
+        for (int i = 0; i < SIZE; ++i) {
+            sv.EmplaceBack(std::make_unique<int>(i));
+        }
+        sv.Erase(sv.begin());
+        sv.Emplace(sv.begin() + 1, std::make_unique<int>(-1));
+        assert(*sv[0] == 1);
+        assert(*sv[1] == -1);
+        assert(*sv[SIZE - 1] == SIZE - 1);
+    }
+}
+
+// growth policy tests
+
+namespace {
+
+    template <typename Vec>
+    size_t CountReallocations(Vec& v, size_t size) {
+        size_t reallocations = 0;
+        for (size_t i = 0; i < size; ++i) {
+            const size_t capacity = v.Capacity();
+            v.Resize(v.Size() + 1);
+            reallocations += v.Capacity() != capacity;
+        }
+        return reallocations;
+    }
+
+}  // namespace
+
+void TestGrowthPolicy() {
+    const size_t SIZE = 1000;
+    {
+        // Resize in a loop is amortized as well
+        Vector<int> v;
+        assert(CountReallocations(v, SIZE) == 11);
+        v.Reserve(SIZE * 3);
+        assert(v.Capacity() == SIZE * 3);
+    }
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        size_t expected[] = { 1, 2, 3, 4, 6, 9, 13, 19 };
+        for (size_t capacity : expected) {
+            while (v.Size() < v.Capacity()) {
+                v.PushBack(0);
+            }
+            v.PushBack(0);
+            assert(v.Capacity() == capacity);
+        }
+    }
+    {
+        // 12 bytes -> 16 bytes class, 5000 bytes -> two pages
+        Vector<char[12], std::allocator<char[12]>, SizeClassGrowth<>> v;
+        v.Reserve(1);
+        assert(v.Capacity() == 1);
+        Vector<char, std::allocator<char>, SizeClassGrowth<>> c;
+        c.Reserve(12);
+        assert(c.Capacity() == 16);
+        c.Reserve(5000);
+        assert(c.Capacity() == 8192);
+        c.Resize(8193);
+        assert(c.Capacity() == 8192 * 2);
+    }
+    {
+        using Capped = CappedGrowth<1024>;
+        Vector<int, std::allocator<int>, Capped> v(SIZE);
+        v.PushBack(1);
+        assert(v.Capacity() == SIZE + 256);
+        v.Resize(SIZE * 10);
+        assert(v.Capacity() == SIZE * 10);
+        assert(v[SIZE] == 1);
+    }
+    {
+        // Fit rounds 3 pages up to a power of two past reservation,
+        // Reserve and constructors are cut to max_size() like growth
+        using Reserved = Vector<int, VirtualReserveAllocator<int>, SizeClassGrowth<DoublingGrowth, (1 << 20)>>;
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        VirtualReserveAllocator<int> alloc(page * 3);
+        const size_t max_size = alloc.max_size();
+        Reserved v(alloc);
+        v.Reserve(max_size);
+        assert(v.Capacity() == max_size);
+        Reserved sized(max_size, alloc);
+        assert(sized.Capacity() == max_size);
+        Reserved copy(sized, alloc);
+        assert(copy.Capacity() == max_size && copy.Size() == max_size);
+    }
+}
+
+void TestRemapVector() {
+    const size_t SIZE = 100'000;
+    {
+        // small threshold: both realloc and mremap paths are taken
+        Vector<uint64_t, RemapAllocator<uint64_t, 4096>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(i * 3);
+        }
+        for (size_t i = 0; i < SIZE; i += 997) {
+            assert(v[i] == i * 3);
+        }
+        v.Insert(v.begin() + 1, v[SIZE - 1]);
+        assert(v[1] == (SIZE - 1) * 3);
+        assert(v[2] == 3);
+
+        Vector<uint64_t, RemapAllocator<uint64_t, 4096>> copy(v);
+        copy.Resize(SIZE * 4);
+        assert(copy[SIZE] == (SIZE - 1) * 3);
+        assert(copy[SIZE * 4 - 1] == 0);
+    }
+    {
+        // argument aliases element of buffer that is about to move
+        Vector<Handle, RemapAllocator<Handle, 4096>> v;
+        v.EmplaceBack(7);
+        for (size_t i = 1; i < SIZE / 10; ++i) {
+            v.PushBack(v[0]);
+        }
+        assert(v[SIZE / 10 - 1].id == 7);
+    }
+    assert(Handle::num_alive == 0);
+}
+
+void TestStableVector() {
+    const size_t SIZE = 200'000;
+    {
+        StableVector<std::string> v(VirtualReserveAllocator<std::string>(size_t(1) << 28));
+        v.PushBack("first");
+        const std::string* first = &v[0];
+        auto it = v.begin();
+        for (size_t i = 1; i < SIZE; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        // no relocation - old pointers and iterators still valid
+        assert(&v[0] == first);
+        assert(it == v.begin());
+        assert(*it == "first");
+        v.Resize(SIZE * 2);
+        v.Reserve(SIZE * 4);
+        assert(&v[0] == first);
+        assert(v[SIZE - 1] == std::to_string(SIZE - 1));
+
+        StableVector<std::string> moved(std::move(v));
+        assert(&moved[0] == first);
+    }
+    {
+        // growth past reservation fails instead of relocating
+        StableVector<int> v(VirtualReserveAllocator<int>(1 << 16));
+        v.Resize(v.GetAllocator().MaxSize());
+        int* data = &v[0];
+        try {
+            v.PushBack(1);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::bad_alloc&) {
+        }
+        assert(&v[0] == data);
+        assert(v.Size() == v.GetAllocator().MaxSize());
+    }
+    {
+        // growth steps are cut to reservation (3 pages, not a power of two elements),
+        // so all of it is used in place
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        StableVector<int> v(VirtualReserveAllocator<int>(page * 3));
+        const size_t max_size = v.GetAllocator().MaxSize();
+        v.PushBack(0);
+        const int* data = v.begin();
+        for (size_t i = 1; i < max_size; ++i) {
+            v.PushBack(static_cast<int>(i));
+            assert(v.begin() == data);
+        }
+        assert(v.Size() == max_size && v.Capacity() == max_size);
+        try {
+            v.EmplaceBack(-1);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::bad_alloc&) {
+        }
+        assert(v.begin() == data && v.Size() == max_size && v[max_size - 1] == static_cast<int>(max_size - 1));
+    }
+}
+
+void TestHugePageVector() {
+    const size_t HUGE = HugePageAllocator<int>::HUGE_PAGE_SIZE;
+    const size_t SIZE = HUGE / sizeof(uint64_t) * 2;
+    for (HugePageMode mode : { HugePageMode::ADVISE, HugePageMode::EXPLICIT }) {
+        HugePageVector<uint64_t> v(HugePageAllocator<uint64_t>(HUGE, mode));
+        // small block comes from operator new
+        v.Reserve(16);
+        assert(v.begin() != nullptr);
+        // explicit mode falls back to advised mapping when no huge pages are reserved
+        v.Resize(SIZE);
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % HUGE == 0);
+        for (size_t i = 0; i < SIZE; i += 4096) {
+            v[i] = i;
+        }
+        v.PushBack(42);
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % HUGE == 0);
+        assert(v[4096] == 4096);
+        assert(v[SIZE] == 42);
+
+        HugePageVector<uint64_t> copy(v);
+        assert(copy.GetAllocator() == v.GetAllocator());
+        assert(copy[SIZE] == 42);
+    }
+}
+
+namespace {
+
+    struct alignas(64) CacheLine {
+        int value = 0;
+    };
+
+}  // namespace
+
+void TestAlignedVector() {
+    const size_t SIZE = 1000;
+    {
+        // over-aligned type with default allocator
+        Vector<CacheLine> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack().value = static_cast<int>(i);
+            assert(reinterpret_cast<uintptr_t>(&v[i]) % 64 == 0);
+        }
+    }
+    {
+        SimdVector<float> v(3);
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % 64 == 0);
+        assert(v.Capacity() == 16);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(1.0f);
+            assert(v.Capacity() % 16 == 0);
+        }
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % 64 == 0);
+
+        SimdVector<double, 32> d;
+        d.Reserve(5);
+        assert(reinterpret_cast<uintptr_t>(d.begin()) % 32 == 0);
+        assert(d.Capacity() == 8);
+
+        // odd element size: 16 elements make 192 = lcm(64, 12) bytes
+        Vector<char[12], AlignedAllocator<char[12], 64>, SimdPaddedGrowth<64>> odd(1);
+        assert(odd.Capacity() == 16);
+    }
+}
+
+
+// range operation tests
+void TestRangeOperations() {
+    {
+        std::vector<int> src{ 1, 2, 3, 4, 5 };
+        Vector<int> v(src.begin(), src.end());
+        assert(v.Size() == 5 && v.Capacity() == 5);
+        assert(std::equal(v.begin(), v.end(), src.begin()));
+
+        // input iterator is read in one pass
+        std::istringstream in("6 7 8");
+        Vector<int> w(std::istream_iterator<int>(in), std::istream_iterator<int>{});
+        assert(w.Size() == 3 && w[2] == 8);
+
+        v.Append(w.begin(), w.end());
+        assert(v.Size() == 8 && v[5] == 6 && v[7] == 8);
+
+        // middle insert with and without reallocation
+        const int MIDDLE[] = { 10, 11 };
+        v.Reserve(20);
+        auto It = v.Insert(v.begin() + 2, std::begin(MIDDLE), std::end(MIDDLE));
+        assert(It == v.begin() + 2);
+        const int EXPECTED[] = { 1, 2, 10, 11, 3, 4, 5, 6, 7, 8 };
+        assert(v.Size() == 10 && std::equal(v.begin(), v.end(), std::begin(EXPECTED)));
+        v = Vector<int>(v);
+        assert(v.Capacity() == v.Size());
+        v.Insert(v.begin(), 3, v[9]);
+        assert(v.Size() == 13 && v[0] == 8 && v[2] == 8 && v[3] == 1);
+
+        std::istringstream tail("20 21");
+        v.Insert(v.begin() + 1, std::istream_iterator<int>(tail), std::istream_iterator<int>{});
+        assert(v.Size() == 15 && v[1] == 20 && v[2] == 21 && v[3] == 8);
+
+        It = v.Erase(v.begin() + 1, v.begin() + 5);
+        assert(v.Size() == 11 && *It == 1);
+
+        v.Assign(4, 7);
+        assert(v.Size() == 4 && v[3] == 7);
+        v.Assign(src.begin(), src.end());
+        assert(v.Size() == 5 && v[4] == 5);
+        v.Clear();
+        assert(v.Size() == 0);
+    }
+    {
+        Vector<std::string> v;
+        v.Assign(3, "abc");
+        std::vector<std::string> src{ "x", "y", "z", "w" };
+        // tail shorter than range, then longer than range
+        v.Reserve(20);
+        v.Insert(v.begin() + 2, src.begin(), src.end());
+        v.Insert(v.begin() + 1, src.begin(), src.begin() + 1);
+        const std::string EXPECTED[] = { "abc", "x", "abc", "x", "y", "z", "w", "abc" };
+        assert(v.Size() == 8 && std::equal(v.begin(), v.end(), std::begin(EXPECTED)));
+        v.Insert(v.end(), 2, v[0]);
+        assert(v.Size() == 10 && v[9] == "abc");
+        v.Erase(v.begin(), v.begin() + 7);
+        assert(v.Size() == 3 && v[0] == "abc");
+        v.Assign(src.begin(), src.begin() + 2);
+        assert(v.Size() == 2 && v[1] == "y");
+    }
+    Obj3::ResetCounters();
+    {
+        Vector<Obj3> v(5);
+        std::vector<Obj3> src(3);
+        src[1].throw_on_copy = true;
+        try {
+            v.Insert(v.begin() + 1, src.begin(), src.end());
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        catch (...) {
+            assert(false && "Unexpected exception");
+        }
+        // reallocating insert failed: vector is untouched
+        assert(v.Size() == 5 && v.Capacity() == 5);
+        src[1].throw_on_copy = false;
+        v.Insert(v.begin() + 1, src.begin(), src.end());
+        assert(v.Size() == 8);
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+}
+
+// erase tests
+void TestEraseOperations() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        auto It = v.SwapErase(v.begin());
+        assert(*It == static_cast<int>(SIZE - 1) && v.Size() == SIZE - 1);
+        It = v.SwapErase(v.end() - 1);
+        assert(It == v.end() && v.Size() == SIZE - 2);
+
+        size_t erased = v.EraseIf([](int x) { return x % 3 == 0; });
+        assert(erased == 333 && v.Size() == SIZE - 2 - 333);
+        assert(std::none_of(v.begin(), v.end(), [](int x) { return x % 3 == 0; }));
+        assert(v.EraseIf([](int) { return false; }) == 0);
+    }
+    {
+        Vector<std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        v.SwapErase(v.begin() + 1);
+        assert(v[1] == std::to_string(SIZE - 1) && v.Size() == SIZE - 1);
+        size_t erased = v.EraseIf([](const std::string& s) { return s.size() < 3; });
+        assert(erased == 99 && v.Size() == SIZE - 1 - 99);
+        assert(v[0] == std::to_string(SIZE - 1) && v[1] == "100");
+    }
+    {
+        // one call per element, same predicate object throughout
+        Vector<int> ints;
+        Vector<std::string> strings;
+        for (size_t i = 0; i < SIZE; ++i) {
+            ints.PushBack(static_cast<int>(i));
+            strings.PushBack(std::to_string(i));
+        }
+        size_t calls = 0;
+        auto every_second = [&calls, odd = false](const auto&) mutable {
+            ++calls;
+            odd = !odd;
+            return odd;
+        };
+        assert(ints.EraseIf(every_second) == SIZE / 2);
+        assert(calls == SIZE && ints.Size() == SIZE / 2);
+        calls = 0;
+        assert(strings.EraseIf(every_second) == SIZE / 2);
+        assert(calls == SIZE && strings.Size() == SIZE / 2);
+        for (size_t i = 0; i < SIZE / 2; ++i) {
+            assert(ints[i] == static_cast<int>(2 * i + 1));
+            assert(strings[i] == std::to_string(2 * i + 1));
+        }
+    }
+    {
+        // word of zeros, word of ones, mixed word and partial last word
+        const size_t COUNT = 200;
+        uint64_t mask[(COUNT + 63) / 64] = { 0, ~uint64_t(0), 0x5555555555555555ull, 0xFFull };
+        Vector<int> ints;
+        Vector<std::string> strings;
+        for (size_t i = 0; i < COUNT; ++i) {
+            ints.PushBack(static_cast<int>(i));
+            strings.PushBack(std::to_string(i));
+        }
+        std::vector<int> expected;
+        for (size_t i = 0; i < COUNT; ++i) {
+            if ((mask[i / 64] >> (i % 64) & 1) == 0) {
+                expected.push_back(static_cast<int>(i));
+            }
+        }
+        assert(ints.EraseMarked(mask) == COUNT - expected.size());
+        assert(strings.EraseMarked(mask) == COUNT - expected.size());
+        assert(ints.Size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            assert(ints[i] == expected[i]);
+            assert(strings[i] == std::to_string(expected[i]));
+        }
+        const uint64_t NONE[4] = {};
+        assert(ints.EraseMarked(NONE) == 0);
+    }
+    Obj3::ResetCounters();
+    {
+        Vector<Obj3> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.SwapErase(v.begin() + 10);
+        assert(v[10].id == 99);
+        assert(v.EraseIf([](const Obj3& obj) { return obj.id % 2 == 1; }) == 50);
+        assert(Obj3::GetAliveObj3ectCount() == 49);
+        uint64_t mask[1] = { ~uint64_t(0) };
+        assert(v.EraseMarked(mask) == 49);
+        assert(Obj3::GetAliveObj3ectCount() == 0);
+    }
+}
+
+// default-init tests
+void TestDefaultInit() {
+    const size_t SIZE = 4096;
+    {
+        Vector<char> buffer(SIZE, default_init);
+        assert(buffer.Size() == SIZE && buffer.Capacity() == SIZE);
+        std::memset(buffer.begin(), 'x', SIZE);
+        buffer.ResizeDefaultInit(SIZE * 2);
+        assert(buffer.Size() == SIZE * 2 && buffer[SIZE - 1] == 'x');
+        buffer.ResizeDefaultInit(10);
+        assert(buffer.Size() == 10 && buffer[9] == 'x');
+
+        // filler writes part of the tail, like read() returning fewer bytes
+        const std::string PAYLOAD = "payload";
+        buffer.ResizeForOverwrite(SIZE, [&](char* data, size_t size) {
+            assert(size == SIZE && data[9] == 'x');
+            std::memcpy(data + 10, PAYLOAD.data(), PAYLOAD.size());
+            return 10 + PAYLOAD.size();
+        });
+        assert(buffer.Size() == 17 && std::string(buffer.begin() + 10, buffer.end()) == PAYLOAD);
+
+        try {
+            buffer.ResizeForOverwrite(20, [](char*, size_t size) { return size + 1; });
+            assert(false && "Exception is expected");
+        }
+        catch (const std::length_error&) {
+        }
+        catch (...) {
+            assert(false && "Unexpected exception");
+        }
+        assert(buffer.Size() == 17);
+    }
+    {
+        // non-trivial types are still default-constructed
+        Vector<std::string> v(3, default_init);
+        assert(v.Size() == 3 && v[2].empty());
+        v.ResizeDefaultInit(100);
+        assert(v.Size() == 100 && v[99].empty());
+    }
+}
+
+// shrink tests
+void TestShrink() {
+    const size_t SIZE = 1024;
+    {
+        Vector<std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        v.Erase(v.begin() + 10, v.end());
+        assert(v.Capacity() == SIZE);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10 && v.Size() == 10 && v[9] == "9");
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0 && v.begin() == nullptr);
+    }
+    {
+        Vector<int, std::allocator<int>, ShrinkingGrowth<>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        assert(v.Capacity() == SIZE);
+        while (v.Size() > SIZE / 4) {
+            v.PopBack();
+        }
+        assert(v.Capacity() == SIZE);
+        v.PopBack();
+        assert(v.Capacity() == (SIZE / 4 - 1) * 2);
+        assert(v[SIZE / 4 - 2] == static_cast<int>(SIZE / 4 - 2));
+
+        // hysteresis: no reallocations around one boundary
+        const size_t capacity = v.Capacity();
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+            v.PopBack();
+            v.PopBack();
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == capacity);
+
+        v.Resize(1);
+        assert(v.Capacity() == 256 / sizeof(int));
+        v.EraseIf([](int) { return true; });
+        assert(v.Capacity() == 256 / sizeof(int));
+    }
+    Obj3::ResetCounters();
+    {
+        Vector<Obj3, std::allocator<Obj3>, ShrinkingGrowth<8, DoublingGrowth, 0>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        v.Erase(v.begin(), v.begin() + (SIZE - 100));
+        assert(v.Capacity() == 200 && v[0].id == static_cast<int>(SIZE - 100));
+        v.SwapErase(v.begin());
+        v.Erase(v.begin(), v.end());
+        assert(v.Capacity() == 0);
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+    {
+        // move assignment releases old elements right away
+        Vector<Obj3> a(10);
+        Vector<Obj3> b(5);
+        a = std::move(b);
+        assert(Obj3::GetAliveObj3ectCount() == 5);
+        assert(b.Size() == 0 && b.Capacity() == 0);
+    }
+}
+
+// bulk copy tests
+void TestTrivialCopy() {
+    const size_t SIZE = 100000;
+    {
+        Vector<double> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = i * 0.5;
+        }
+        Vector<double> copy(v);
+        assert(copy.Size() == SIZE && std::equal(v.begin(), v.end(), copy.begin()));
+
+        // assignment into bigger, smaller and empty buffers
+        Vector<double> small(10);
+        Vector<double> big(SIZE * 2);
+        Vector<double> empty;
+        small = v;
+        big = v;
+        empty = v;
+        assert(big.Capacity() == SIZE * 2);
+        for (const Vector<double>* p : { &small, &big, &empty }) {
+            assert(p->Size() == SIZE && std::equal(v.begin(), v.end(), p->begin()));
+        }
+        big = Vector<double>(3);
+        assert(big.Size() == 3 && big[2] == 0.0);
+        Vector<double> tail(5);
+        big = tail;
+        assert(big.Size() == 5);
+    }
+    {
+        // unaligned head, 64-byte body and tail of streaming copy
+        const size_t BYTES = 1000;
+        std::vector<char> src(BYTES + 16), dst(BYTES + 16, 0);
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = static_cast<char>(i * 7);
+        }
+        for (size_t offset = 0; offset < 16; offset += 3) {
+            std::fill(dst.begin(), dst.end(), 0);
+            CopyNonTemporal(dst.data() + offset, src.data() + 1, BYTES - offset);
+            assert(std::equal(dst.begin() + offset, dst.begin() + BYTES, src.begin() + 1));
+            assert(dst[BYTES] == 0);
+        }
+    }
+}
+
+// concurrent vector tests
+void TestConcurrentVector() {
+    const size_t THREADS = 8;
+    const size_t PER_THREAD = 10000;
+    {
+        ConcurrentVector<size_t> v;
+        v.PushBack(0);
+        const size_t* first = &v[0];
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&v, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    size_t index = v.PushBack(t * PER_THREAD + i + 1);
+                    assert(v[index] == t * PER_THREAD + i + 1);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        // no element was moved by growth
+        assert(&v[0] == first);
+        assert(v.Size() == THREADS * PER_THREAD + 1);
+        assert(v.Capacity() >= v.Size());
+        std::vector<bool> seen(v.Size(), false);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v.IsConstructed(i));
+            assert(!seen[v[i]]);
+            seen[v[i]] = true;
+        }
+    }
+    {
+        ConcurrentVector<std::string> v(100);
+        assert(v.Capacity() >= 100 && v.Size() == 0);
+        for (int i = 0; i < 1000; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        assert(v[999] == "999");
+    }
+    Obj3::ResetCounters();
+    {
+        ConcurrentVector<Obj3> v;
+        Obj3 obj(1);
+        v.PushBack(obj);
+        obj.throw_on_copy = true;
+        try {
+            v.PushBack(obj);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        catch (...) {
+            assert(false && "Unexpected exception");
+        }
+        obj.throw_on_copy = false;
+        v.PushBack(obj);
+        assert(v.Size() == 3 && v[2].id == 1);
+        assert(v.IsConstructed(0) && !v.IsConstructed(1) && v.IsConstructed(2));
+    }
+    // failed slot isn't destroyed
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+}
+
+void BenchmarkConcurrentVector() {
+    using namespace std::string_view_literals;
+    const size_t TOTAL = size_t(1) << 20;
+
+    auto measure = [](size_t threads_count, auto push) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threads_count; ++t) {
+            threads.emplace_back([&push, threads_count] {
+                for (size_t i = 0; i < TOTAL / threads_count; ++i) {
+                    push(i);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::cerr << "ConcurrentVector vs mutex + Vector, "sv << TOTAL << " pushes:"sv << std::endl;
+    for (size_t threads_count = 1; threads_count <= 64; threads_count *= 2) {
+        ConcurrentVector<size_t> concurrent;
+        auto lock_free_ms = measure(threads_count, [&concurrent](size_t i) {
+            concurrent.PushBack(i);
+        });
+
+        std::mutex mutex;
+        Vector<size_t> locked;
+        auto mutex_ms = measure(threads_count, [&mutex, &locked](size_t i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            locked.PushBack(i);
+        });
+        assert(concurrent.Size() == locked.Size());
+
+        std::cerr << "threads: "sv << threads_count
+            << ", lock-free: "sv << lock_free_ms << " ms"sv
+            << ", mutex: "sv << mutex_ms << " ms"sv << std::endl;
+    }
+}
+
+// segmented vector tests
+void TestSegmentedVector() {
+    const size_t SIZE = 1000;
+    {
+        SegmentedVector<std::string, 16> v;
+        v.PushBack("first");
+        const std::string* first = &v[0];
+        for (size_t i = 1; i < SIZE; ++i) {
+            v.EmplaceBack(std::to_string(i));
+        }
+        // growth never moves elements
+        assert(&v[0] == first && *first == "first");
+        assert(v.Size() == SIZE && v.Capacity() == 1008 && v.ChunkCount() == 63);
+        assert(v[SIZE - 1] == std::to_string(SIZE - 1));
+
+        // element can be appended from itself
+        v.PushBack(v[1]);
+        assert(v[SIZE] == "1");
+
+        size_t count = 0;
+        for (const std::string& s : v) {
+            assert(!s.empty());
+            ++count;
+        }
+        assert(count == v.Size());
+        assert(std::find(v.begin(), v.end(), "500") - v.begin() == 500);
+        assert(v.end() - v.begin() == static_cast<std::ptrdiff_t>(v.Size()));
+
+        SegmentedVector<std::string, 16> copy(v);
+        assert(copy.Size() == v.Size() && std::equal(v.begin(), v.end(), copy.begin()));
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Size() == 10 && v.ChunkCount() == 1 && &v[0] == first);
+        copy = v;
+        assert(copy.Size() == 10 && copy[9] == "9");
+        SegmentedVector<std::string, 16> moved(std::move(copy));
+        assert(moved.Size() == 10 && copy.Size() == 0);
+    }
+    Obj3::ResetCounters();
+    {
+        SegmentedVector<Obj3> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        // elements are never moved or copied
+        assert(Obj3::num_moved == 0 && Obj3::num_copied == 0);
+        v.Resize(SIZE / 2);
+        assert(Obj3::GetAliveObj3ectCount() == static_cast<int>(SIZE / 2));
+        std::sort(v.begin(), v.end(), [](const Obj3& lhs, const Obj3& rhs) { return lhs.id > rhs.id; });
+        assert(v[0].id == static_cast<int>(SIZE / 2 - 1));
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+    // throwing element constructor: constructed elements are destroyed
+    {
+        SegmentedVector<Obj3> v(SIZE);
+        try {
+            v[SIZE / 2].throw_on_copy = true;
+            SegmentedVector<Obj3> v_copy(v);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+            assert(Obj3::num_copied == SIZE / 2);
+        }
+        assert(Obj3::GetAliveObj3ectCount() == static_cast<int>(SIZE));
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+    Obj3::default_construction_throw_countdown = static_cast<int>(SIZE / 2);
+    try {
+        SegmentedVector<Obj3> v(SIZE);
+        assert(false && "Exception is expected");
+    }
+    catch (const std::runtime_error&) {
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+}
+
+// parallel algorithm tests
+void TestParallelAlgorithms() {
+    const size_t SIZE = 100000;
+    const size_t GRAIN = 1000;
+    ThreadPool pool(4);
+    assert(pool.Size() == 4);
+
+    Vector<int> v(SIZE);
+    parallel::Fill(v.begin(), v.end(), 1, GRAIN, pool);
+    assert(std::all_of(v.begin(), v.end(), [](int x) { return x == 1; }));
+
+    std::atomic<size_t> visited{ 0 };
+    parallel::ForEach(v.begin(), v.end(), [&visited](int& x) {
+        x = static_cast<int>(visited.fetch_add(1)) % 7;
+    }, GRAIN, pool);
+    assert(visited == SIZE);
+
+    Vector<double> scores(SIZE);
+    double* out_end = parallel::Transform(v.cbegin(), v.cend(), scores.begin(),
+        [](int x) { return x * 0.5; }, GRAIN, pool);
+    assert(out_end == scores.end());
+    for (size_t i = 0; i < SIZE; ++i) {
+        assert(scores[i] == v[i] * 0.5);
+    }
+
+    long long expected = std::accumulate(v.begin(), v.end(), 0LL);
+    assert(parallel::Reduce(v.begin(), v.end(), 0LL, std::plus<>(), GRAIN, pool) == expected);
+    assert(parallel::Reduce(v.begin(), v.begin() + 1, 10LL, std::plus<>(), GRAIN, pool) == 10 + v[0]);
+    assert(parallel::Reduce(v.begin(), v.begin(), 5LL, std::plus<>(), GRAIN, pool) == 5);
+
+    // fold of another type, chunk results joined by combine
+    {
+        Vector<std::string> words(SIZE / 10);
+        for (size_t i = 0; i < words.Size(); ++i) {
+            words[i] = std::to_string(i);
+        }
+        size_t chars = 0;
+        for (const std::string& word : words) {
+            chars += word.size();
+        }
+        assert(parallel::Reduce(words.begin(), words.end(), size_t(1),
+            [](size_t n, const std::string& word) { return n + word.size(); }, std::plus<>(), 100, pool) == chars + 1);
+    }
+    // result without default constructor
+    {
+        struct Sum {
+            explicit Sum(long long value) : value(value) { }
+            Sum(int value) : value(value) { }
+            long long value;
+        };
+        const Sum sum = parallel::Reduce(v.begin(), v.end(), Sum(1), [](const Sum& lhs, const Sum& rhs) {
+            return Sum(lhs.value + rhs.value);
+        }, GRAIN, pool);
+        assert(sum.value == expected + 1);
+    }
+
+    assert(parallel::Count(v.begin(), v.end(), 3, GRAIN, pool)
+        == static_cast<size_t>(std::count(v.begin(), v.end(), 3)));
+    assert(parallel::CountIf(v.begin(), v.end(), [](int x) { return x > 4; }, GRAIN, pool)
+        == static_cast<size_t>(std::count_if(v.begin(), v.end(), [](int x) { return x > 4; })));
+
+    // first of several matches, and no match
+    std::fill(v.begin(), v.end(), 0);
+    v[SIZE / 2] = 42;
+    v[SIZE / 3] = 42;
+    v[SIZE - 1] = 42;
+    assert(parallel::Find(v.begin(), v.end(), 42, GRAIN, pool) == v.begin() + SIZE / 3);
+    assert(parallel::Find(v.begin(), v.end(), 43, GRAIN, pool) == v.end());
+
+    // default pool and grain
+    assert(parallel::Count(v.begin(), v.end(), 42) == 3);
+
+    // exception from body reaches caller
+    try {
+        parallel::ForEach(v.begin(), v.end(), [](int x) {
+            if (x == 42) {
+                throw std::runtime_error("Oops");
+            }
+        }, GRAIN, pool);
+        assert(false && "Exception is expected");
+    }
+    catch (const std::runtime_error&) {
+    }
+    catch (...) {
+        assert(false && "Unexpected exception");
+    }
+
+    // nested loops on the same pool don't deadlock
+    std::atomic<size_t> inner{ 0 };
+    pool.ParallelFor(16, 1, [&](size_t, size_t) {
+        pool.ParallelFor(100, 10, [&inner](size_t begin, size_t end) {
+            inner.fetch_add(end - begin);
+        });
+    });
+    assert(inner == 1600);
+}
+
+// work stealing tests
+namespace {
+
+    long long ForkJoinSum(const int* first, const int* last, WorkStealingScheduler& scheduler) {
+        if (last - first <= 1000) {
+            return std::accumulate(first, last, 0LL);
+        }
+        const int* middle = first + (last - first) / 2;
+        long long left = 0;
+        TaskGroup group(scheduler);
+        group.Spawn([&] { left = ForkJoinSum(first, middle, scheduler); });
+        long long right = ForkJoinSum(middle, last, scheduler);
+        group.Sync();
+        return left + right;
+    }
+
+    // inner vectors of very different sizes - fixed chunks balance them badly
+    Vector<Vector<int>> MakeNested(size_t outer) {
+        Vector<Vector<int>> nested(outer);
+        for (size_t i = 0; i < outer; ++i) {
+            nested[i].Resize(i % 16 == 0 ? 200000 : 1000);
+            std::fill(nested[i].begin(), nested[i].end(), static_cast<int>(i % 5));
+        }
+        return nested;
+    }
+
+}  // namespace
+
+void TestWorkStealing() {
+    {
+        ChaseLevDeque<int> deque(2);
+        for (int i = 0; i < 100; ++i) {
+            deque.Push(i);
+        }
+        int item = -1;
+        assert(deque.Steal(item) && item == 0);
+        assert(deque.Pop(item) && item == 99);
+        for (int i = 98; i >= 1; --i) {
+            assert(deque.Pop(item) && item == i);
+        }
+        assert(!deque.Pop(item) && !deque.Steal(item) && deque.Empty());
+    }
+    {
+        // owner pushes and pops while thieves steal: every item is taken once
+        const int ITEMS = 100000;
+        ChaseLevDeque<int> deque;
+        std::vector<std::atomic<int>> taken(ITEMS);
+        std::atomic<bool> done{ false };
+        std::vector<std::thread> thieves;
+        for (int t = 0; t < 3; ++t) {
+            thieves.emplace_back([&] {
+                int item = 0;
+                while (!done.load() || !deque.Empty()) {
+                    if (deque.Steal(item)) {
+                        taken[item].fetch_add(1);
+                    }
+                }
+            });
+        }
+        int item = 0;
+        for (int i = 0; i < ITEMS; ++i) {
+            deque.Push(i);
+            if (i % 3 == 0 && deque.Pop(item)) {
+                taken[item].fetch_add(1);
+            }
+        }
+        while (deque.Pop(item)) {
+            taken[item].fetch_add(1);
+        }
+        done = true;
+        for (std::thread& thief : thieves) {
+            thief.join();
+        }
+        assert(std::all_of(taken.begin(), taken.end(), [](const std::atomic<int>& n) { return n == 1; }));
+    }
+
+    WorkStealingScheduler scheduler(4);
+    assert(scheduler.Size() == 4);
+    {
+        Vector<int> v(1000000);
+        std::iota(v.begin(), v.end(), 0);
+        assert(ForkJoinSum(v.begin(), v.end(), scheduler) == std::accumulate(v.begin(), v.end(), 0LL));
+
+        // nested fork/join over Vector<Vector<int>>
+        Vector<Vector<int>> nested = MakeNested(64);
+        std::atomic<long long> total{ 0 };
+        parallel::ForkJoinFor(nested.begin(), nested.end(), [&](Vector<int>* first, Vector<int>* last) {
+            for (; first != last; ++first) {
+                parallel::ForkJoinFor(first->begin(), first->end(), [&total](int* begin, int* end) {
+                    total.fetch_add(std::accumulate(begin, end, 0LL));
+                }, 4096, scheduler);
+            }
+        }, 1, scheduler);
+        long long expected = 0;
+        for (const Vector<int>& inner : nested) {
+            expected += std::accumulate(inner.begin(), inner.end(), 0LL);
+        }
+        assert(total == expected);
+    }
+    {
+        TaskGroup group(scheduler);
+        std::atomic<int> finished{ 0 };
+        for (int i = 0; i < 100; ++i) {
+            group.Spawn([i, &finished] {
+                if (i == 50) {
+                    throw std::runtime_error("Oops");
+                }
+                ++finished;
+            });
+        }
+        try {
+            group.Sync();
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        catch (...) {
+            assert(false && "Unexpected exception");
+        }
+        // other tasks still run
+        assert(finished == 99);
+    }
+}
+
+void BenchmarkWorkStealing() {
+    using namespace std::string_view_literals;
+    const size_t THREADS = 4;
+    Vector<Vector<int>> nested = MakeNested(256);
+    auto score = [](int x) { return static_cast<long long>(x) * x + 1; };
+
+    auto measure = [](auto run) {
+        auto start = std::chrono::steady_clock::now();
+        long long result = run();
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(result, ms);
+    };
+
+    auto serial = measure([&] {
+        long long total = 0;
+        for (const Vector<int>& inner : nested) {
+            for (int x : inner) {
+                total += score(x);
+            }
+        }
+        return total;
+    });
+
+    ThreadPool pool(THREADS);
+    auto chunked = measure([&] {
+        std::atomic<long long> total{ 0 };
+        parallel::ForEach(nested.begin(), nested.end(), [&](Vector<int>& inner) {
+            pool.ParallelFor(inner.Size(), 16384, [&](size_t begin, size_t end) {
+                long long sum = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    sum += score(inner[i]);
+                }
+                total += sum;
+            });
+        }, 16, pool);
+        return total.load();
+    });
+
+    WorkStealingScheduler scheduler(THREADS);
+    auto stealing = measure([&] {
+        std::atomic<long long> total{ 0 };
+        parallel::ForkJoinFor(nested.begin(), nested.end(), [&](Vector<int>* first, Vector<int>* last) {
+            for (; first != last; ++first) {
+                parallel::ForkJoinFor(first->begin(), first->end(), [&](int* begin, int* end) {
+                    long long sum = 0;
+                    for (; begin != end; ++begin) {
+                        sum += score(*begin);
+                    }
+                    total += sum;
+                }, 16384, scheduler);
+            }
+        }, 1, scheduler);
+        return total.load();
+    });
+    assert(chunked.first == serial.first && stealing.first == serial.first);
+
+    std::cerr << "nested Vector<Vector<int>>, "sv << THREADS << " threads:"sv << std::endl
+        << "serial: "sv << serial.second << " ms"sv
+        << ", thread pool: "sv << chunked.second << " ms"sv
+        << ", work stealing: "sv << stealing.second << " ms"sv << std::endl;
+}
+
+// every kernel against plain loops, sizes around register widths leave tails of any length
+template <typename T>
+void CheckSimdKernels() {
+    for (size_t size : { 1, 2, 3, 7, 8, 15, 16, 17, 31, 33, 64, 65, 100, 1001 }) {
+        Vector<T> v(size);
+        Vector<T> w(size);
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<T>((i * 37) % 101) - static_cast<T>(50);
+            w[i] = static_cast<T>(i % 5);
+        }
+
+        assert(simd::Find(v, v[size - 1]) == std::find(v.begin(), v.end(), v[size - 1]));
+        assert(simd::Find(v, static_cast<T>(1000)) == v.end());
+        assert(!simd::Contains(v, static_cast<T>(-1000)));
+        assert(simd::Contains(v, v[size / 2]));
+        assert(simd::Count(v, v[0]) == static_cast<size_t>(std::count(v.begin(), v.end(), v[0])));
+
+        auto [low, high] = simd::MinMax(v);
+        assert(low == *std::min_element(v.begin(), v.end()));
+        assert(high == *std::max_element(v.begin(), v.end()));
+
+        // small integers, so float sums are exact in any order
+        assert(simd::Sum(v) == std::accumulate(v.begin(), v.end(), T()));
+        assert(simd::Dot(v, w) == std::inner_product(v.begin(), v.end(), w.begin(), T()));
+    }
+
+    // match in every position of a register and of the unrolled block
+    Vector<T> zeros(70);
+    std::fill(zeros.begin(), zeros.end(), T());
+    for (size_t i = 0; i < zeros.Size(); ++i) {
+        zeros[i] = static_cast<T>(1);
+        assert(simd::Find(zeros, static_cast<T>(1)) == zeros.begin() + i);
+        zeros[i] = T();
+    }
+
+    Vector<T> empty;
+    assert(simd::Find(empty, T()) == empty.end());
+    assert(simd::Count(empty, T()) == 0);
+    assert(simd::Sum(empty) == T());
+    assert(simd::Dot(empty, empty) == T());
+}
+
+void TestSimdKernels() {
+    const simd::Isa best = simd::DetectIsa();
+    assert(simd::GetIsa() == best);
+
+    for (simd::Isa isa : { simd::Isa::SCALAR, simd::Isa::SSE2, simd::Isa::AVX2, simd::Isa::AVX512 }) {
+        simd::SetIsa(isa);
+        assert(simd::GetIsa() == std::min(isa, best));
+        CheckSimdKernels<int32_t>();
+        CheckSimdKernels<int64_t>();
+        CheckSimdKernels<float>();
+        CheckSimdKernels<double>();
+    }
+    simd::SetIsa(best);
+
+    // integer sums wrap instead of overflowing
+    Vector<int32_t> big(33);
+    std::fill(big.begin(), big.end(), std::numeric_limits<int32_t>::max());
+    int32_t wrapped = static_cast<int32_t>(33u * static_cast<uint32_t>(std::numeric_limits<int32_t>::max()));
+    assert(simd::Sum(big) == wrapped);
+
+    // works on any allocator
+    Vector<double, AlignedAllocator<double, 64>> aligned(100);
+    std::fill(aligned.begin(), aligned.end(), 0.5);
+    assert(simd::Sum(aligned) == 50.0);
+    assert(simd::Dot(aligned, aligned) == 25.0);
+}
+
+// structure of arrays tests
+
+namespace {
+
+    // copy throws once copies_left runs out, move may throw too (so containers copy it)
+    struct Fragile {
+        Fragile() {
+            ++num_alive;
+        }
+        explicit Fragile(int id) : id(id) {
+            ++num_alive;
+        }
+        Fragile(const Fragile& other) : id(other.id) {
+            if (copies_left == 0) {
+                throw std::runtime_error("Oops");
+            }
+            --copies_left;
+            ++num_alive;
+        }
+        Fragile(Fragile&& other) : id(other.id) {
+            ++num_alive;
+        }
+        Fragile& operator=(const Fragile&) = default;
+        ~Fragile() {
+            --num_alive;
+        }
+
+        int id = 0;
+
+        static inline int num_alive = 0;
+        static inline size_t copies_left = SIZE_MAX;
+    };
+
+}  // namespace
+
+void TestSoaVector() {
+    const size_t SIZE = 1000;
+    {
+        SoaVector<float, int, std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            auto [x, id, name] = v.EmplaceBack(i * 0.5f, static_cast<int>(i), std::to_string(i));
+            assert(x == i * 0.5f && id == static_cast<int>(i) && name == std::to_string(i));
+        }
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+
+        // columns are plain arrays
+        Span<int> ids = v.Column<1>();
+        assert(ids.Size() == SIZE && ids.Data() == &v.Get<1>(0));
+        assert(std::accumulate(ids.begin(), ids.end(), 0LL) == static_cast<long long>(SIZE * (SIZE - 1) / 2));
+        for (float& x : v.Column<0>()) {
+            x *= 2;
+        }
+        assert(v.Get<0>(10) == 10.0f);
+
+        // proxy references write through
+        for (auto [x, id, name] : v) {
+            assert(x == static_cast<float>(id));
+            name += "!";
+        }
+        assert(v.Get<2>(7) == "7!");
+        v[3] = std::make_tuple(-1.0f, -1, std::string("minus"));
+        assert(std::get<2>(v[3]) == "minus");
+        auto it = std::find_if(v.begin(), v.end(), [](const auto& row) { return std::get<1>(row) == 500; });
+        assert(it - v.begin() == 500 && std::get<0>(*it) == 500.0f);
+
+        // row can be appended from itself while columns grow
+        v.Resize(v.Capacity());
+        const size_t last = v.Size();
+        v.EmplaceBack(v.Get<0>(1), v.Get<1>(1), v.Get<2>(1));
+        assert(v.Size() == last + 1 && v.Get<2>(last) == "1!" && v.Get<2>(1) == "1!");
+        assert(v.Get<1>(last - 1) == 0 && v.Get<2>(last - 1).empty());
+
+        const SoaVector<float, int, std::string> copy(v);
+        assert(copy.Size() == v.Size());
+        assert(std::equal(copy.begin(), copy.end(), v.cbegin()));
+        Span<const std::string> names = copy.Column<2>();
+        assert(names[1] == "1!");
+
+        SoaVector<float, int, std::string> moved(std::move(v));
+        assert(moved.Size() == copy.Size() && v.Size() == 0);
+        v = copy;
+        assert(v.Size() == copy.Size());
+        v.Swap(moved);
+        moved.Resize(5);
+        assert(moved.Size() == 5 && moved.Get<2>(4) == "4!");
+        moved.PopBack();
+        moved.Clear();
+        assert(moved.Size() == 0);
+
+        v.Reserve(SIZE * 4);
+        assert(v.Capacity() >= SIZE * 4 && v.Get<2>(999) == "999!");
+    }
+    {
+        // failed copy in Reserve leaves vector as it was
+        SoaVector<int, Fragile, std::string> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i, Fragile(i), std::to_string(i));
+        }
+        const size_t capacity = v.Capacity();
+        Fragile::copies_left = 5;
+        try {
+            v.Reserve(capacity * 2);
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        Fragile::copies_left = SIZE_MAX;
+        assert(v.Capacity() == capacity && v.Size() == 10);
+        assert(v.Get<1>(9).id == 9 && v.Get<2>(9) == "9");
+        assert(Fragile::num_alive == 10);
+
+        // failed construction of one field destroys other fields of the row
+        Fragile::copies_left = 0;
+        const Fragile source(42);
+        try {
+            v.EmplaceBack(1, source, "never");
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        Fragile::copies_left = SIZE_MAX;
+        assert(v.Size() == 10 && Fragile::num_alive == 11);
+    }
+    assert(Fragile::num_alive == 0);
+    {
+        // move-only column with throwing move is moved on growth
+        struct Unique {
+            explicit Unique(int id) : id(std::make_unique<int>(id)) { }
+            Unique(Unique&& other) : id(std::move(other.id)) { }
+            std::unique_ptr<int> id;
+        };
+        SoaVector<int, Unique> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i, Unique(i));
+        }
+        for (int i = 0; i < 100; ++i) {
+            assert(v.Get<0>(i) == i && *v.Get<1>(i).id == i);
+        }
+    }
+    // throwing element constructor: constructed rows are destroyed
+    Obj3::ResetCounters();
+    Obj3::default_construction_throw_countdown = static_cast<int>(SIZE / 2);
+    try {
+        SoaVector<std::string, Obj3> v(SIZE);
+        assert(false && "Exception is expected");
+    }
+    catch (const std::runtime_error&) {
+    }
+    assert(Obj3::GetAliveObj3ectCount() == 0);
+}
+
+void BenchmarkSoaVector() {
+    using namespace std::string_view_literals;
+    const size_t SIZE = size_t(1) << 20;
+    const int REPEATS = 20;
+
+    // 64-byte record, loop reads one field
+    struct Order {
+        double price = 0;
+        double quantity = 0;
+        int64_t id = 0;
+        int64_t timestamp = 0;
+        char venue[32] = {};
+    };
+
+    Vector<Order> rows(SIZE);
+    SoaVector<double, double, int64_t, int64_t> columns;
+    double expected = 0;
+    for (size_t i = 0; i < SIZE; ++i) {
+        rows[i].price = static_cast<double>(i % 100);
+        columns.EmplaceBack(static_cast<double>(i % 100), 1.0, static_cast<int64_t>(i), int64_t(0));
+        expected += static_cast<double>(i % 100);
+    }
+
+    auto measure = [expected](auto scan) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            double sum = scan();
+            assert(sum == expected);
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto rows_ms = measure([&rows] {
+        double sum = 0;
+        for (const Order& order : rows) {
+            sum += order.price;
+        }
+        return sum;
+    });
+    auto columns_ms = measure([&columns] {
+        Span<double> prices = columns.Column<0>();
+        return std::accumulate(prices.begin(), prices.end(), 0.0);
+    });
+    std::cerr << "sum of one field, "sv << SIZE << " records: Vector<Order>: "sv << rows_ms << " ms"sv
+        << ", SoaVector: "sv << columns_ms << " ms"sv << std::endl;
+}
+
+// copy-on-write tests
+
+void TestCowVector() {
+    const size_t SIZE = 100;
+    {
+        CowVector<std::string> v;
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.UseCount() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        assert(v.Size() == SIZE && v.UseCount() == 1);
+
+        // copy shares block
+        CowVector<std::string> copy = v;
+        assert(copy.Data() == v.Data() && v.UseCount() == 2);
+        assert(std::equal(copy.begin(), copy.end(), v.begin()));
+
+        // first mutation clones, other copy keeps old values
+        copy.Mutable(0) = "zero";
+        assert(copy.Data() != v.Data() && v.UseCount() == 1 && copy.UseCount() == 1);
+        assert(v[0] == "0" && copy[0] == "zero" && copy[SIZE - 1] == std::to_string(SIZE - 1));
+        // own block changes in place
+        const std::string* data = copy.Data();
+        copy.Mutable(1) = "one";
+        assert(copy.Data() == data);
+
+        CowVector<std::string> appended = v;
+        appended.PushBack(appended[5]);
+        assert(appended.Size() == SIZE + 1 && appended[SIZE] == "5" && v.Size() == SIZE);
+
+        CowVector<std::string> popped = v;
+        popped.PopBack();
+        assert(popped.Size() == SIZE - 1 && v.Size() == SIZE && v[SIZE - 1] == std::to_string(SIZE - 1));
+
+        CowVector<std::string> resized = v;
+        resized.Resize(SIZE * 3);
+        assert(resized.Size() == SIZE * 3 && resized[SIZE * 3 - 1].empty() && v.Size() == SIZE);
+        resized.Resize(1);
+        assert(resized.Size() == 1 && resized[0] == "0");
+
+        // Clear of shared block only drops reference
+        CowVector<std::string> cleared = v;
+        cleared.Clear();
+        assert(cleared.Size() == 0 && v.UseCount() == 1 && v[3] == "3");
+
+        CowVector<std::string> moved = std::move(copy);
+        assert(moved[0] == "zero" && copy.Size() == 0 && copy.Data() == nullptr);
+        moved = v;
+        assert(moved.Data() == v.Data() && v.UseCount() == 2);
+        moved = CowVector<std::string>(v.begin(), v.begin() + 10);
+        assert(moved.Size() == 10 && v.UseCount() == 1);
+    }
+    {
+        // failed clone leaves both copies as they were
+        Obj5::ResetCounters();
+        CowVector<Obj5> v(10);
+        CowVector<Obj5> copy = v;
+        v.Mutable(5);   // own block of v
+        copy = v;
+        Obj5& source = v.Mutable(5);   // clones: copy keeps the old block
+        source.throw_on_copy = true;
+        CowVector<Obj5> shared = v;
+        try {
+            shared.PushBack(Obj5(1));
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(shared.Data() == v.Data() && shared.Size() == 10 && v.UseCount() == 2);
+    }
+    assert(Obj5::GetAliveObj5ectCount() == 0);
+    // throwing element constructor: constructed elements are destroyed
+    Obj5::default_construction_throw_countdown = 5;
+    try {
+        CowVector<Obj5> v(10);
+        assert(false && "Exception is expected");
+    }
+    catch (const std::runtime_error&) {
+    }
+    assert(Obj5::GetAliveObj5ectCount() == 0);
+    {
+        Vector<Obj5> source(10);
+        source[5].throw_on_copy = true;
+        try {
+            CowVector<Obj5> v(source.begin(), source.end());
+            assert(false && "Exception is expected");
+        }
+        catch (const std::runtime_error&) {
+        }
+        assert(Obj5::GetAliveObj5ectCount() == 10);
+    }
+    assert(Obj5::GetAliveObj5ectCount() == 0);
+    {
+        // copies shared by threads, each one mutates its own
+        CowVector<int> table(1000);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&table, t] {
+                for (int i = 0; i < 100; ++i) {
+                    CowVector<int> local = table;
+                    assert(std::accumulate(local.begin(), local.end(), 0) == 0);
+                    if (i % 10 == 0) {
+                        local.Mutable(0) = t;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        assert(table.UseCount() == 1 && table[0] == 0);
+    }
+}
+
+void BenchmarkCowVector() {
+    using namespace std::string_view_literals;
+    const size_t TABLE_SIZE = 10000;
+    const size_t REQUESTS = 1000;
+
+    // every request copies routing table into its context and reads a few routes,
+    // one in a hundred adds a route
+    auto measure = [](auto table) {
+        auto start = std::chrono::steady_clock::now();
+        size_t checksum = 0;
+        for (size_t request = 0; request < REQUESTS; ++request) {
+            auto context = table;
+            checksum += context[request % TABLE_SIZE].size();
+            if (request % 100 == 0) {
+                context.PushBack("extra");
+                checksum += context.Size();
+            }
+        }
+        assert(checksum != 0);
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+
+    Vector<std::string> routes;
+    CowVector<std::string> cow_routes;
+    for (size_t i = 0; i < TABLE_SIZE; ++i) {
+        routes.PushBack("/api/v1/route/" + std::to_string(i));
+        cow_routes.PushBack(routes[i]);
+    }
+    auto vector_ms = measure(routes);
+    auto cow_ms = measure(cow_routes);
+    std::cerr << REQUESTS << " request contexts with "sv << TABLE_SIZE << " routes: Vector: "sv << vector_ms
+        << " ms"sv << ", CowVector: "sv << cow_ms << " ms"sv << std::endl;
+}
+
+// persistent vector tests
+
+namespace {
+
+    template <typename T>
+    bool SameElements(const PersistentVector<T>& v, const std::vector<T>& model) {
+        if (v.Size() != model.size() || !std::equal(v.begin(), v.end(), model.begin(), model.end())) {
+            return false;
+        }
+        for (size_t i = 0; i < model.size(); ++i) {
+            if (v[i] != model[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}  // namespace
+
+void TestPersistentVector() {
+    const size_t SIZE = 5000;
+    {
+        PersistentVector<int> empty;
+        assert(empty.Size() == 0 && empty.begin() == empty.end());
+
+        // every version stays as it was
+        std::vector<PersistentVector<int>> versions{ empty };
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            versions.push_back(versions.back().PushBack(i));
+        }
+        for (size_t n = 0; n <= SIZE; n += 97) {
+            assert(versions[n].Size() == n);
+            for (size_t i = 0; i < n; ++i) {
+                assert(versions[n][i] == static_cast<int>(i));
+            }
+        }
+
+        const PersistentVector<int>& full = versions.back();
+        PersistentVector<int> changed = full.Set(0, -1).Set(SIZE / 2, -2).Set(SIZE - 1, -3);
+        assert(changed[0] == -1 && changed[SIZE / 2] == -2 && changed[SIZE - 1] == -3);
+        assert(full[0] == 0 && full[SIZE / 2] == static_cast<int>(SIZE / 2) && full[SIZE - 1] == static_cast<int>(SIZE - 1));
+
+        PersistentVector<int> popped = full;
+        for (size_t i = 0; i < SIZE; ++i) {
+            popped = popped.PopBack();
+        }
+        assert(popped.Size() == 0 && full.Size() == SIZE);
+
+        // Vector conversion round trip
+        Vector<int> flat = full.ToVector();
+        assert(flat.Size() == SIZE && std::equal(flat.begin(), flat.end(), full.begin()));
+        PersistentVector<int> back(flat);
+        assert(back.Size() == SIZE && std::equal(back.begin(), back.end(), flat.begin()));
+        assert(back.PushBack(7)[SIZE] == 7);
+    }
+    {
+        // random edits, slices and concatenations against std::vector
+        uint64_t state = 12345;
+        auto next = [&state](size_t bound) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<size_t>((state >> 33) % bound);
+        };
+        std::vector<std::pair<PersistentVector<int>, std::vector<int>>> pool(4);
+        for (int step = 0; step < 2000; ++step) {
+            auto& [v, model] = pool[next(pool.size())];
+            const auto& [other, other_model] = pool[next(pool.size())];
+            switch (next(6)) {
+            case 0: {
+                const size_t count = next(100);
+                for (size_t i = 0; i < count; ++i) {
+                    v = v.PushBack(step);
+                    model.push_back(step);
+                }
+                break;
+            }
+            case 1:
+                if (!model.empty()) {
+                    const size_t index = next(model.size());
+                    v = v.Set(index, -step);
+                    model[index] = -step;
+                }
+                break;
+            case 2:
+                if (!model.empty()) {
+                    v = v.PopBack();
+                    model.pop_back();
+                }
+                break;
+            case 3: {
+                const size_t last = next(model.size() + 1);
+                const size_t first = next(last + 1);
+                v = v.Slice(first, last);
+                model = std::vector<int>(model.begin() + first, model.begin() + last);
+                break;
+            }
+            default: {
+                PersistentVector<int> joined = v.Concat(other);
+                std::vector<int> joined_model = model;
+                joined_model.insert(joined_model.end(), other_model.begin(), other_model.end());
+                // keeps pool sizes bounded
+                if (joined_model.size() < 20000) {
+                    v = std::move(joined);
+                    model = std::move(joined_model);
+                }
+                break;
+            }
+            }
+            assert(SameElements(v, model));
+        }
+        for (const auto& [v, model] : pool) {
+            assert(SameElements(v, model));
+        }
+    }
+    {
+        // deep trees of both heights, concatenated many times
+        PersistentVector<int> small;
+        for (int i = 0; i < 33; ++i) {
+            small = small.PushBack(i);
+        }
+        PersistentVector<int> big;
+        std::vector<int> model;
+        for (int round = 0; round < 200; ++round) {
+            PersistentVector<int> piece = round % 3 == 0 ? big.Slice(big.Size() / 3, big.Size() / 2) : small;
+            std::vector<int> piece_model = round % 3 == 0
+                ? std::vector<int>(model.begin() + model.size() / 3, model.begin() + model.size() / 2)
+                : std::vector<int>(small.begin(), small.end());
+            big = round % 2 == 0 ? big.Concat(piece) : piece.Concat(big);
+            model.insert(round % 2 == 0 ? model.end() : model.begin(), piece_model.begin(), piece_model.end());
+        }
+        assert(SameElements(big, model));
+    }
+    {
+        // transient writes own nodes in place, snapshots keep their elements
+        PersistentVector<std::string> base;
+        PersistentVector<std::string>::Transient batch(base);
+        for (size_t i = 0; i < SIZE; ++i) {
+            batch.PushBack(std::to_string(i));
+        }
+        PersistentVector<std::string> snapshot = batch.Persistent();
+        batch.Set(0, "zero");
+        batch.PopBack();
+        batch.Append(snapshot.Slice(0, 10));
+        assert(snapshot.Size() == SIZE && snapshot[0] == "0" && snapshot[SIZE - 1] == std::to_string(SIZE - 1));
+        assert(batch.Size() == SIZE - 1 + 10 && batch[0] == "zero" && batch[SIZE - 1] == "0");
+        PersistentVector<std::string> result = std::move(batch).Persistent();
+        assert(result.Size() == SIZE + 9 && result[SIZE + 8] == "9" && base.Size() == 0);
+    }
+}
+
+void TestBitVector() {
+    uint64_t state = 777;
+    auto next = [&state](size_t bound) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<size_t>((state >> 33) % bound);
+    };
+    auto same_bits = [](const BitVector& bits, const std::vector<bool>& model) {
+        if (bits.Size() != model.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < model.size(); ++i) {
+            if (bits[i] != model[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+    {
+        BitVector bits;
+        assert(bits.Size() == 0 && bits.PopCount() == 0 && bits.FindFirst() == 0 && bits.FindFirst(false) == 0);
+
+        // edits around word boundaries
+        std::vector<bool> model;
+        for (size_t i = 0; i < 300; ++i) {
+            bits.PushBack(i % 3 == 0);
+            model.push_back(i % 3 == 0);
+        }
+        assert(same_bits(bits, model) && bits.WordCount() == 5);
+        bits[64] = true;
+        bits[65] = bits[0];
+        bits[0].Flip();
+        model[64] = true;
+        model[65] = model[0];
+        model[0] = !model[0];
+        assert(same_bits(bits, model));
+        for (size_t i = 0; i < 50; ++i) {
+            bits.PopBack();
+            model.pop_back();
+        }
+        assert(same_bits(bits, model) && bits.WordCount() == 4);
+
+        bits.Resize(400, true);
+        model.resize(400, true);
+        assert(same_bits(bits, model));
+        bits.Resize(130);
+        model.resize(130);
+        bits.Resize(200);
+        model.resize(200);
+        // bits cut off come back as 0
+        assert(same_bits(bits, model));
+
+        BitVector ones(100, true);
+        assert(ones.PopCount() == 100 && ones.FindFirst(false) == 100 && ones.Data()[1] == (uint64_t(1) << 36) - 1);
+        ones.Clear();
+        assert(ones.Size() == 0 && ones.PopCount() == 0);
+    }
+    {
+        // scans and set operations against std::vector<bool>
+        for (size_t size : { size_t(1), size_t(63), size_t(64), size_t(65), size_t(1000), size_t(5000) }) {
+            BitVector a(size);
+            BitVector b(size);
+            std::vector<bool> model_a(size);
+            std::vector<bool> model_b(size);
+            // sparse a, dense b
+            for (size_t i = 0; i < size; ++i) {
+                model_a[i] = next(20) == 0;
+                model_b[i] = next(20) != 0;
+                a.Set(i, model_a[i]);
+                b.Set(i, model_b[i]);
+            }
+            for (bool value : { true, false }) {
+                std::vector<size_t> found;
+                for (size_t i = a.FindFirst(value); i < a.Size(); i = a.FindNext(i, value)) {
+                    found.push_back(i);
+                }
+                std::vector<size_t> expected;
+                for (size_t i = 0; i < size; ++i) {
+                    if (model_a[i] == value) {
+                        expected.push_back(i);
+                    }
+                }
+                assert(found == expected);
+            }
+            assert(a.PopCount() == static_cast<size_t>(std::count(model_a.begin(), model_a.end(), true)));
+
+            auto check = [&](void (BitVector::*operation)(const BitVector&), auto combine) {
+                BitVector result = a;
+                (result.*operation)(b);
+                std::vector<bool> model(size);
+                for (size_t i = 0; i < size; ++i) {
+                    model[i] = combine(model_a[i], model_b[i]);
+                }
+                assert(same_bits(result, model));
+                assert(result.PopCount() == static_cast<size_t>(std::count(model.begin(), model.end(), true)));
+            };
+            check(&BitVector::And, [](bool x, bool y) { return x && y; });
+            check(&BitVector::Or, [](bool x, bool y) { return x || y; });
+            check(&BitVector::Xor, [](bool x, bool y) { return x != y; });
+            check(&BitVector::AndNot, [](bool x, bool y) { return x && !y; });
+
+            BitVector other_size(size + 1);
+            try {
+                a.And(other_size);
+                assert(false);
+            }
+            catch (const std::invalid_argument&) {
+            }
+        }
+    }
+    {
+        // rank and select over several superblocks, both densities
+        for (size_t percent : { size_t(1), size_t(50), size_t(100) }) {
+            const size_t SIZE = 20000;
+            BitVector bits(SIZE);
+            for (size_t i = 0; i < SIZE; ++i) {
+                bits.Set(i, next(100) < percent);
+            }
+            bits.BuildRankIndex();
+            size_t rank = 0;
+            for (size_t i = 0; i < SIZE; ++i) {
+                assert(bits.Rank(i) == rank);
+                if (bits[i]) {
+                    assert(bits.Select(rank) == i);
+                    ++rank;
+                }
+            }
+            assert(bits.Rank(SIZE) == rank && bits.PopCount() == rank);
+            assert(bits.Select(rank) == SIZE);
+
+            // index follows changes after rebuild
+            bits.Resize(SIZE + 1, true);
+            bits.BuildRankIndex();
+            assert(bits.Rank(SIZE + 1) == rank + 1 && bits.Select(rank) == SIZE);
+        }
+    }
+    {
+        // mask for Vector::EraseMarked
+        const size_t COUNT = 1000;
+        Vector<int> values;
+        BitVector odd;
+        for (size_t i = 0; i < COUNT; ++i) {
+            values.PushBack(static_cast<int>(i));
+            odd.PushBack(i % 2 == 1);
+        }
+        assert(values.EraseMarked(odd.Data()) == COUNT / 2);
+        assert(values.Size() == COUNT / 2 && values[1] == 2);
+    }
+}
+
+void BenchmarkBitVector() {
+    using namespace std::string_view_literals;
+    const size_t SIZE = size_t(1) << 24;
+    const int REPEATS = 10;
+
+    Vector<bool> flags_a(SIZE);
+    Vector<bool> flags_b(SIZE);
+    BitVector bits_a(SIZE);
+    BitVector bits_b(SIZE);
+    for (size_t i = 0; i < SIZE; ++i) {
+        flags_a[i] = i % 3 == 0;
+        flags_b[i] = i % 5 != 0;
+        bits_a.Set(i, flags_a[i]);
+        bits_b.Set(i, flags_b[i]);
+    }
+    // multiples of 3 not of 5
+    const size_t expected = (SIZE + 2) / 3 - (SIZE + 14) / 15;
+
+    auto measure = [expected](auto intersect) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            size_t count = intersect();
+            assert(count == expected);
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto flags_ms = measure([&] {
+        Vector<bool> result = flags_a;
+        size_t count = 0;
+        for (size_t i = 0; i < SIZE; ++i) {
+            result[i] = result[i] && flags_b[i];
+            count += result[i];
+        }
+        return count;
+    });
+    auto bits_ms = measure([&] {
+        BitVector result = bits_a;
+        result.And(bits_b);
+        return result.PopCount();
+    });
+    std::cerr << "and + count of "sv << SIZE << " flags: Vector<bool>: "sv << flags_ms << " ms ("sv << SIZE / (1 << 20)
+        << " MB), BitVector: "sv << bits_ms << " ms ("sv << SIZE / 8 / (1 << 20) << " MB)"sv << std::endl;
+}
+
+template <typename T>
+void CheckPackedIntVector(const std::vector<T>& values) {
+    PackedIntVector<T> packed(values.begin(), values.end());
+    assert(packed.Size() == values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        assert(packed[i] == values[i]);
+    }
+    std::vector<T> scanned;
+    packed.ForEach([&scanned](T value) {
+        scanned.push_back(value);
+    });
+    assert(scanned == values);
+    Vector<T> flat = packed.ToVector();
+    assert(flat.Size() == values.size() && std::equal(flat.begin(), flat.end(), values.begin()));
+
+    // one by one gives the same blocks
+    PackedIntVector<T> appended;
+    for (T value : values) {
+        appended.Append(value);
+    }
+    assert(appended.Size() == values.size());
+    for (size_t i = 0; i < values.size(); i += 7) {
+        assert(appended.Get(i) == values[i]);
+    }
+}
+
+template <typename T>
+void CheckPackedIntWidths() {
+    uint64_t state = 4242;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state ^ (state >> 29);
+    };
+    // every width, with tail
+    for (size_t width = 0; width <= sizeof(T) * 8; ++width) {
+        const T mask = width == sizeof(T) * 8 ? std::numeric_limits<T>::max() : static_cast<T>((T(1) << width) - 1);
+        const T base = static_cast<T>(next()) & ~mask;
+        std::vector<T> values;
+        for (size_t i = 0; i < 3 * PackedIntVector<T>::BLOCK + 5; ++i) {
+            values.push_back(static_cast<T>(base + (static_cast<T>(next()) & mask)));
+        }
+        // extremes of width in each block
+        values[1] = base;
+        values[2] = static_cast<T>(base + mask);
+        CheckPackedIntVector(values);
+    }
+    CheckPackedIntVector(std::vector<T>{});
+    CheckPackedIntVector(std::vector<T>(PackedIntVector<T>::BLOCK, std::numeric_limits<T>::max()));
+    // delta blocks between frame of reference blocks
+    std::vector<T> values;
+    for (size_t i = 0; i < 4 * PackedIntVector<T>::BLOCK; ++i) {
+        const bool sorted = i / PackedIntVector<T>::BLOCK % 2 == 0;
+        values.push_back(sorted ? static_cast<T>(i * 3) : static_cast<T>(next()));
+    }
+    CheckPackedIntVector(values);
+}
+
+void TestPackedIntVector() {
+    CheckPackedIntWidths<uint16_t>();
+    CheckPackedIntWidths<uint32_t>();
+    CheckPackedIntWidths<uint64_t>();
+    {
+        // posting list: sorted ids, gaps below 32
+        const size_t SIZE = 100000;
+        Vector<uint32_t> ids;
+        uint32_t id = 1000000;
+        for (size_t i = 0; i < SIZE; ++i) {
+            id += static_cast<uint32_t>(1 + i * 7 % 31);
+            ids.PushBack(id);
+        }
+        PackedIntVector<uint32_t> packed(ids);
+        packed.ShrinkToFit();
+        ids.ShrinkToFit();
+        // 7 bits of deltas per id instead of 32, 8 with block headers
+        assert(packed.MemoryBytes() * 3 < ids.Capacity() * sizeof(uint32_t));
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(packed[i] == ids[i]);
+        }
+
+        PackedIntVector<uint32_t> other;
+        other.Swap(packed);
+        assert(packed.Size() == 0 && other.Size() == SIZE && other[SIZE - 1] == ids[SIZE - 1]);
+        other.Clear();
+        assert(other.Size() == 0 && other.BlockCount() == 0);
+        other.Append(ids.begin(), ids.begin() + 300);
+        assert(other.Size() == 300 && other.BlockCount() == 3 && other[299] == ids[299]);
+
+        // moved-from vector can be refilled
+        PackedIntVector<uint32_t> moved = std::move(other);
+        other.Append(ids.begin(), ids.begin() + 200);
+        assert(other.Size() == 200 && other[150] == ids[150] && moved.Size() == 300);
+    }
+    {
+        // timestamps in one day
+        std::vector<uint64_t> timestamps;
+        uint64_t time = 1700000000000ULL;
+        for (size_t i = 0; i < 10000; ++i) {
+            time += i % 13 * 1000 + i % 7;
+            timestamps.push_back(time);
+        }
+        CheckPackedIntVector(timestamps);
+    }
+}
+
+void BenchmarkPackedIntVector() {
+    using namespace std::string_view_literals;
+    const size_t SIZE = size_t(1) << 22;
+    const int REPEATS = 20;
+
+    Vector<uint32_t> ids;
+    uint32_t id = 0;
+    for (size_t i = 0; i < SIZE; ++i) {
+        id += static_cast<uint32_t>(1 + i * 7919 % 16);
+        ids.PushBack(id);
+    }
+    PackedIntVector<uint32_t> packed(ids);
+    packed.ShrinkToFit();
+    const uint64_t expected = std::accumulate(ids.begin(), ids.end(), uint64_t(0));
+
+    auto measure = [expected](auto scan) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            uint64_t sum = scan();
+            assert(sum == expected);
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto raw_ms = measure([&ids] {
+        return std::accumulate(ids.begin(), ids.end(), uint64_t(0));
+    });
+    auto packed_ms = measure([&packed] {
+        uint64_t sum = 0;
+        packed.ForEach([&sum](uint32_t value) {
+            sum += value;
+        });
+        return sum;
+    });
+    std::cerr << "sum of "sv << SIZE << " ids: Vector: "sv << raw_ms << " ms ("sv << ids.Capacity() * sizeof(uint32_t) / 1024
+        << " KB), PackedIntVector: "sv << packed_ms << " ms ("sv << packed.MemoryBytes() / 1024 << " KB)"sv << std::endl;
+}
+
+void TestVectorIo() {
+    struct Row {
+        uint64_t id;
+        double price;
+        uint32_t quantity;
+    };
+    char path[] = "/tmp/vector_io_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    auto rewrite = [fd](auto write) {
+        assert(ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0);
+        write();
+    };
+    {
+        const size_t SIZE = 100000;
+        Vector<Row> rows;
+        for (size_t i = 0; i < SIZE; ++i) {
+            rows.PushBack(Row{ i, i * 0.5, static_cast<uint32_t>(i % 1000) });
+        }
+        rewrite([&] {
+            WriteTo(fd, rows);
+        });
+
+        MappedVectorView<Row> view{ std::string(path) };
+        assert(view.Size() == SIZE && view.VerifyChecksum());
+        assert(reinterpret_cast<uintptr_t>(view.Data()) % alignof(Row) == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(view[i].id == rows[i].id && view[i].price == rows[i].price && view[i].quantity == rows[i].quantity);
+        }
+        size_t count = 0;
+        for (const Row& row : view) {
+            count += row.id == count;
+        }
+        assert(count == SIZE);
+
+        // moves hand over mapping, Vector copies out of it
+        MappedVectorView<Row> moved = std::move(view);
+        assert(view.Size() == 0 && view.begin() == view.end() && moved.Size() == SIZE);
+        Vector<Row> copy(moved.begin(), moved.end());
+        assert(copy.Size() == SIZE && copy[SIZE - 1].id == SIZE - 1);
+
+        // mapping from caller's descriptor
+        MappedVectorView<Row> from_fd(fd);
+        assert(from_fd.Size() == SIZE && from_fd[7].quantity == 7);
+    }
+    {
+        // empty vector and over-aligned elements
+        rewrite([&] {
+            WriteTo(fd, Vector<int>());
+        });
+        MappedVectorView<int> empty{ std::string(path) };
+        assert(empty.Size() == 0 && empty.VerifyChecksum());
+
+        struct alignas(64) Line {
+            char bytes[64];
+        };
+        Vector<Line> lines(3);
+        lines[2].bytes[63] = 'x';
+        rewrite([&] {
+            WriteTo(fd, lines);
+        });
+        MappedVectorView<Line> view{ std::string(path) };
+        assert(view.Size() == 3 && view[2].bytes[63] == 'x');
+        assert(reinterpret_cast<uintptr_t>(view.Data()) % 64 == 0);
+    }
+    {
+        // flips of top bit in two elements (signs of doubles) don't cancel
+        Vector<double> values;
+        for (double value : { 1.5, -2.0, 3.25, 4.0 }) {
+            values.PushBack(value);
+        }
+        rewrite([&] {
+            WriteTo(fd, values);
+        });
+        const double flipped[] = { -1.5, 2.0 };
+        assert(pwrite(fd, flipped, sizeof(flipped), sizeof(VectorFileHeader)) == sizeof(flipped));
+        MappedVectorView<double> view{ std::string(path) };
+        assert(view[0] == -1.5 && view[1] == 2.0 && !view.VerifyChecksum());
+        assert(VectorFileChecksum(values.begin(), sizeof(flipped)) != VectorFileChecksum(flipped, sizeof(flipped)));
+    }
+    {
+        // bad files are rejected on opening, damaged elements by checksum
+        const Vector<uint32_t> values(1000);
+        rewrite([&] {
+            WriteTo(fd, values);
+        });
+        auto opens = [&path](auto type_tag) {
+            try {
+                MappedVectorView<decltype(type_tag)> view{ std::string(path) };
+                return true;
+            }
+            catch (const std::runtime_error&) {
+                return false;
+            }
+        };
+        assert(opens(uint32_t()) && !opens(uint64_t()) && !opens(uint16_t()));
+
+        const uint32_t damaged = 1;
+        assert(pwrite(fd, &damaged, sizeof(damaged), sizeof(VectorFileHeader) + 40) == sizeof(damaged));
+        assert(opens(uint32_t()) && !MappedVectorView<uint32_t>(std::string(path)).VerifyChecksum());
+
+        assert(ftruncate(fd, sizeof(VectorFileHeader) + 100) == 0);
+        assert(!opens(uint32_t()));
+
+        const uint32_t version = VectorFileHeader::VERSION + 1;
+        assert(pwrite(fd, &version, sizeof(version), offsetof(VectorFileHeader, version)) == sizeof(version));
+        assert(!opens(uint32_t()));
+
+        assert(pwrite(fd, "garbage!", 8, 0) == 8);
+        assert(!opens(uint32_t()));
+
+        assert(ftruncate(fd, 10) == 0);
+        assert(!opens(uint32_t()));
+
+        try {
+            MappedVectorView<int> missing{ std::string("/nonexistent/vector.bin") };
+            assert(false);
+        }
+        catch (const std::system_error& e) {
+            assert(e.code() == std::errc::no_such_file_or_directory);
+        }
+    }
+    close(fd);
+    unlink(path);
+}
+
+void BenchmarkVectorIo() {
+    using namespace std::string_view_literals;
+    const size_t SIZE = size_t(1) << 20;
+
+    char path[] = "/tmp/vector_io_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    Vector<uint64_t> values;
+    std::ostringstream text;
+    for (size_t i = 0; i < SIZE; ++i) {
+        values.PushBack(i * 2654435761ULL);
+        text << values[i] << '\n';
+    }
+    WriteTo(fd, values);
+    close(fd);
+    const uint64_t expected = std::accumulate(values.begin(), values.end(), uint64_t(0));
+    const std::string lines = text.str();
+
+    auto measure = [expected](auto load) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sum = load();
+        assert(sum == expected);
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    };
+
+    // both load and read every element once
+    auto parse_us = measure([&lines] {
+        std::istringstream input(lines);
+        Vector<uint64_t> loaded;
+        for (uint64_t value; input >> value;) {
+            loaded.PushBack(value);
+        }
+        return std::accumulate(loaded.begin(), loaded.end(), uint64_t(0));
+    });
+    auto map_us = measure([&path] {
+        MappedVectorView<uint64_t> view{ std::string(path) };
+        return std::accumulate(view.begin(), view.end(), uint64_t(0));
+    });
+    std::cerr << "load of "sv << SIZE << " values: parse + PushBack: "sv << parse_us / 1000 << " ms"sv
+        << ", MappedVectorView: "sv << map_us / 1000 << " ms"sv << std::endl;
+    unlink(path);
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <numeric>
+
+#include "vector.h"
+
+// allocator with Align-byte aligned blocks through aligned operator new
+// (std::allocator already respects alignas(T), this one is for extra alignment
+// of ordinary types, e.g. 64-byte aligned floats for AVX-512 loads)
+template <typename T, size_t Align = 64>
+class AlignedAllocator {
+    static_assert((Align & (Align - 1)) == 0, "Align must be power of two");
+    static_assert(Align >= alignof(T), "Align can't be weaker than alignof(T)");
+
+public:         // types
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, (Align > alignof(U) ? Align : alignof(U))>;
+    };
+
+public:         // constructors
+    AlignedAllocator() = default;
+    template <typename U, size_t OtherAlign>
+    AlignedAllocator(const AlignedAllocator<U, OtherAlign>&) noexcept { }
+
+public:         // methods
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n) noexcept;
+};
+
+template <typename T, size_t TAlign, typename U, size_t UAlign>
+bool operator==(const AlignedAllocator<T, TAlign>&, const AlignedAllocator<U, UAlign>&) noexcept;
+template <typename T, size_t TAlign, typename U, size_t UAlign>
+bool operator!=(const AlignedAllocator<T, TAlign>&, const AlignedAllocator<U, UAlign>&) noexcept;
+
+// rounds Base's capacity up so capacity * sizeof(T) is a whole number of
+// WidthBytes SIMD registers: vector kernels may run over the tail without
+// scalar epilogue (lanes past Size() hold garbage and must be ignored)
+template <size_t WidthBytes = 64, typename Base = DoublingGrowth>
+struct SimdPaddedGrowth {
+    static size_t Grow(size_t capacity, size_t required, size_t elem_size) noexcept;
+    static size_t Fit(size_t required, size_t elem_size) noexcept;
+
+private:
+    static size_t PadUp(size_t n, size_t elem_size) noexcept;
+};
+
+// aligned and padded vector for SIMD kernels:
+//     SimdVector<float> v(n);  // 64-byte aligned, Capacity() is a multiple of 16
+template <typename T, size_t Align = 64>
+using SimdVector = Vector<T, AlignedAllocator<T, Align>, SimdPaddedGrowth<Align>>;
+
+template <typename T, size_t Align>
+inline T* AlignedAllocator<T, Align>::allocate(size_t n) {
+    if (n > size_t(-1) / sizeof(T)) {
+        throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(operator new(n * sizeof(T), std::align_val_t(Align)));
+}
+
+template <typename T, size_t Align>
+inline void AlignedAllocator<T, Align>::deallocate(T* p, size_t n) noexcept {
+    operator delete(p, n * sizeof(T), std::align_val_t(Align));
+}
+
+template <typename T, size_t TAlign, typename U, size_t UAlign>
+inline bool operator==(const AlignedAllocator<T, TAlign>&, const AlignedAllocator<U, UAlign>&) noexcept {
+    return TAlign == UAlign;
+}
+
+template <typename T, size_t TAlign, typename U, size_t UAlign>
+inline bool operator!=(const AlignedAllocator<T, TAlign>& lhs, const AlignedAllocator<U, UAlign>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+template <size_t WidthBytes, typename Base>
+inline size_t SimdPaddedGrowth<WidthBytes, Base>::Grow(size_t capacity, size_t required, size_t elem_size) noexcept {
+    return PadUp(Base::Grow(capacity, required, elem_size), elem_size);
+}
+
+template <size_t WidthBytes, typename Base>
+inline size_t SimdPaddedGrowth<WidthBytes, Base>::Fit(size_t required, size_t elem_size) noexcept {
+    return PadUp(Base::Fit(required, elem_size), elem_size);
+}
+
+template <size_t WidthBytes, typename Base>
+inline size_t SimdPaddedGrowth<WidthBytes, Base>::PadUp(size_t n, size_t elem_size) noexcept {
+    // smallest element count whose byte size is a multiple of WidthBytes
+    const size_t step = WidthBytes / std::gcd(WidthBytes, elem_size);
+    return (n + step - 1) / step * step;
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "vector.h"
+
+// monotonic bump-pointer arena
+// memory is taken from chained blocks and released all at once by Reset()
+class Arena {
+private:        // types
+    struct Block {
+        Block* next = nullptr;
+        size_t size = 0;            // usable bytes after header
+
+        char* Begin() noexcept;
+        char* End() noexcept;
+    };
+
+private:        // fields
+    size_t block_size_;
+    Block* head_ = nullptr;
+    Block* current_ = nullptr;
+    char* top_ = nullptr;
+    char* limit_ = nullptr;
+
+public:         // constructors
+    explicit Arena(size_t block_size = 64 * 1024);
+
+    Arena(const Arena&) = delete;
+    Arena(Arena&& other) noexcept;
+
+    ~Arena();
+
+public:         // operators
+    Arena& operator=(const Arena&) = delete;
+    Arena& operator=(Arena&&) = delete;
+
+public:         // methods
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    // gives memory back only if it is the last allocation
+    void Deallocate(void* p, size_t bytes) noexcept;
+    // grows last allocation in place, false if p isn't on top or block is full
+    bool Expand(void* p, size_t old_bytes, size_t new_bytes) noexcept;
+    // O(1), all blocks are kept for reuse
+    void Reset() noexcept;
+    size_t BlockCount() const noexcept;
+
+private:        // methods
+    bool FitInto(Block* block, size_t bytes, size_t alignment) noexcept;
+    void* Bump(size_t bytes, size_t alignment) noexcept;
+    Block* NewBlock(size_t bytes, size_t alignment);
+};
+
+// standard allocator over Arena, supports in-place growth for RawMemory
+template <typename T>
+class ArenaAllocator {
+private:        // fields
+    Arena* arena_;
+
+public:         // types
+    using value_type = T;
+
+public:         // constructors
+    ArenaAllocator(Arena* arena) noexcept;
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept;
+
+public:         // methods
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n) noexcept;
+    bool expand(T* p, size_t old_n, size_t new_n) noexcept;
+    Arena* GetArena() const noexcept;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept;
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept;
+
+// scratch vector, freed by Arena::Reset():
+//     Arena arena;
+//     ArenaVector<int> v(&arena);
+template <typename T>
+using ArenaVector = Vector<T, ArenaAllocator<T>>;
+
+inline char* Arena::Block::Begin() noexcept {
+    return reinterpret_cast<char*>(this) + sizeof(Block);
+}
+
+inline char* Arena::Block::End() noexcept {
+    return Begin() + size;
+}
+
+inline Arena::Arena(size_t block_size)
+    : block_size_(block_size) { }
+
+inline Arena::Arena(Arena&& other) noexcept
+    : block_size_(other.block_size_)
+    , head_(std::exchange(other.head_, nullptr))
+    , current_(std::exchange(other.current_, nullptr))
+    , top_(std::exchange(other.top_, nullptr))
+    , limit_(std::exchange(other.limit_, nullptr)) {
+}
+
+inline Arena::~Arena() {
+    while (head_ != nullptr) {
+        Block* next = head_->next;
+        operator delete(head_);
+        head_ = next;
+    }
+}
+
+inline void* Arena::Allocate(size_t bytes, size_t alignment) {
+    if (void* p = Bump(bytes, alignment)) {
+        return p;
+    }
+    // try blocks left after Reset(), then chain a new one after current
+    if (current_ != nullptr && current_->next != nullptr
+        && FitInto(current_->next, bytes, alignment)) {
+        current_ = current_->next;
+    }
+    else {
+        Block* block = NewBlock(bytes, alignment);
+        if (current_ != nullptr) {
+            block->next = current_->next;
+            current_->next = block;
+        }
+        else {
+            head_ = block;
+        }
+        current_ = block;
+    }
+    top_ = current_->Begin();
+    limit_ = current_->End();
+    return Bump(bytes, alignment);
+}
+
+inline void Arena::Deallocate(void* p, size_t bytes) noexcept {
+    char* ptr = static_cast<char*>(p);
+    if (ptr + bytes == top_) {
+        top_ = ptr;
+    }
+}
+
+inline bool Arena::Expand(void* p, size_t old_bytes, size_t new_bytes) noexcept {
+    char* ptr = static_cast<char*>(p);
+    if (ptr + old_bytes != top_ || new_bytes > static_cast<size_t>(limit_ - ptr)) {
+        return false;
+    }
+    top_ = ptr + new_bytes;
+    return true;
+}
+
+inline void Arena::Reset() noexcept {
+    current_ = head_;
+    if (head_ != nullptr) {
+        top_ = head_->Begin();
+        limit_ = head_->End();
+    }
+}
+
+inline size_t Arena::BlockCount() const noexcept {
+    size_t count = 0;
+    for (Block* block = head_; block != nullptr; block = block->next) {
+        ++count;
+    }
+    return count;
+}
+
+inline bool Arena::FitInto(Block* block, size_t bytes, size_t alignment) noexcept {
+    uintptr_t begin = reinterpret_cast<uintptr_t>(block->Begin());
+    uintptr_t aligned = (begin + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    return aligned - begin + bytes <= block->size;
+}
+
+inline void* Arena::Bump(size_t bytes, size_t alignment) noexcept {
+    assert((alignment & (alignment - 1)) == 0);
+    if (top_ == nullptr) {
+        return nullptr;
+    }
+    uintptr_t top = reinterpret_cast<uintptr_t>(top_);
+    uintptr_t aligned = (top + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    if (aligned - top > static_cast<size_t>(limit_ - top_)
+        || bytes > static_cast<size_t>(limit_ - top_) - (aligned - top)) {
+        return nullptr;
+    }
+    top_ = reinterpret_cast<char*>(aligned) + bytes;
+    return reinterpret_cast<void*>(aligned);
+}
+
+inline Arena::Block* Arena::NewBlock(size_t bytes, size_t alignment) {
+    // big requests get a block of their own size
+    size_t size = std::max(block_size_, bytes + alignment);
+    void* memory = operator new(sizeof(Block) + size);
+    Block* block = new (memory) Block;
+    block->size = size;
+    return block;
+}
+
+template <typename T>
+inline ArenaAllocator<T>::ArenaAllocator(Arena* arena) noexcept
+    : arena_(arena) { }
+
+template <typename T>
+template <typename U>
+inline ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+    : arena_(other.GetArena()) { }
+
+template <typename T>
+inline T* ArenaAllocator<T>::allocate(size_t n) {
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+inline void ArenaAllocator<T>::deallocate(T* p, size_t n) noexcept {
+    arena_->Deallocate(p, n * sizeof(T));
+}
+
+template <typename T>
+inline bool ArenaAllocator<T>::expand(T* p, size_t old_n, size_t new_n) noexcept {
+    return arena_->Expand(p, old_n * sizeof(T), new_n * sizeof(T));
+}
+
+template <typename T>
+inline Arena* ArenaAllocator<T>::GetArena() const noexcept {
+    return arena_;
+}
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept {
+    return lhs.GetArena() == rhs.GetArena();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
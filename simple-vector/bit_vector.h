@@ -0,0 +1,436 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "vector.h"
+
+// one bit per flag in 64-bit words (Vector<bool> takes a byte per flag)
+// scans and set operations go word at a time; bits past Size() in the last word are always 0,
+// so Data() can be passed as mask to Vector::EraseMarked
+//     BitVector active(rows), recent(rows);
+//     active.And(recent);
+//     for (size_t i = active.FindFirst(); i < active.Size(); i = active.FindNext(i)) ...
+// Rank and Select need BuildRankIndex() after the last change
+class BitVector {
+public:         // types
+    class Reference;
+
+private:        // types
+    static constexpr size_t WORD_BITS = 64;
+    // rank directory: absolute count per superblock, count within superblock per block
+    static constexpr size_t BLOCK_WORDS = 8;
+    static constexpr size_t SUPERBLOCK_WORDS = 64;
+
+private:        // fields
+    Vector<uint64_t> words_;
+    size_t size_ = 0;
+    Vector<uint64_t> superblock_ranks_;     // ones before each superblock
+    Vector<uint16_t> block_ranks_;          // ones before each block, from its superblock start
+    bool ranked_ = false;                   // rank directory matches words_
+
+public:         // constructors
+    BitVector() = default;
+    explicit BitVector(size_t size, bool value = false);
+
+public:         // operators
+    bool operator[](size_t index) const noexcept;
+    Reference operator[](size_t index) noexcept;
+
+    bool operator==(const BitVector& other) const noexcept;
+    bool operator!=(const BitVector& other) const noexcept;
+
+public:         // methods
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+    // words of bits, bit i is (Data()[i / 64] >> (i % 64)) & 1
+    const uint64_t* Data() const noexcept;
+    size_t WordCount() const noexcept;
+
+    void Reserve(size_t new_capacity);
+    void Resize(size_t new_size, bool value = false);
+    void PushBack(bool value);
+    void PopBack() noexcept;
+    void Clear() noexcept;
+    void Set(size_t index, bool value = true) noexcept;
+    void Flip(size_t index) noexcept;
+    void Swap(BitVector& other) noexcept;
+
+    // ones
+    size_t PopCount() const noexcept;
+    // first index with bit equal to value, Size() if none
+    size_t FindFirst(bool value = true) const noexcept;
+    // first such index after index
+    size_t FindNext(size_t index, bool value = true) const noexcept;
+
+    // in place with bits of other, sizes must be equal (std::invalid_argument)
+    void And(const BitVector& other);
+    void Or(const BitVector& other);
+    void Xor(const BitVector& other);
+    // clears bits set in other
+    void AndNot(const BitVector& other);
+
+    // directory of about 5% of bits for Rank and Select
+    void BuildRankIndex();
+    // ones before index (index <= Size())
+    size_t Rank(size_t index) const noexcept;
+    // index of one number rank (from 0), Size() if there are fewer ones
+    size_t Select(size_t rank) const noexcept;
+
+private:        // methods
+    static size_t WordsFor(size_t bits) noexcept;
+    static size_t PopCount(uint64_t word) noexcept;
+    static size_t CountTrailingZeros(uint64_t word) noexcept;
+    // index of one number rank in word
+    static size_t SelectInWord(uint64_t word, size_t rank) noexcept;
+
+    // zeroes bits past size_ in the last word
+    void ClearPadding() noexcept;
+    void CheckSameSize(const BitVector& other) const;
+    size_t FindFrom(size_t index, bool value) const noexcept;
+};
+
+// proxy for one bit
+class BitVector::Reference {
+private:        // fields
+    BitVector* owner_;
+    size_t index_;
+
+public:         // constructors
+    Reference(BitVector* owner, size_t index) noexcept
+        : owner_(owner), index_(index) { }
+    Reference(const Reference&) = default;
+
+public:         // operators
+    operator bool() const noexcept {
+        return static_cast<const BitVector&>(*owner_)[index_];
+    }
+    Reference& operator=(bool value) noexcept {
+        owner_->Set(index_, value);
+        return *this;
+    }
+    Reference& operator=(const Reference& other) noexcept {
+        return *this = static_cast<bool>(other);
+    }
+
+public:         // methods
+    void Flip() noexcept {
+        owner_->Flip(index_);
+    }
+};
+
+inline BitVector::BitVector(size_t size, bool value)
+    : words_(WordsFor(size))
+    , size_(size) {
+    if (value) {
+        std::fill(words_.begin(), words_.end(), ~uint64_t(0));
+        ClearPadding();
+    }
+}
+
+inline bool BitVector::operator[](size_t index) const noexcept {
+    assert(index < size_);
+    return (words_[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+inline BitVector::Reference BitVector::operator[](size_t index) noexcept {
+    assert(index < size_);
+    return Reference(this, index);
+}
+
+inline bool BitVector::operator==(const BitVector& other) const noexcept {
+    // padding is 0 in both
+    return size_ == other.size_ && std::equal(words_.begin(), words_.end(), other.words_.begin());
+}
+
+inline bool BitVector::operator!=(const BitVector& other) const noexcept {
+    return !(*this == other);
+}
+
+inline size_t BitVector::Size() const noexcept {
+    return size_;
+}
+
+inline size_t BitVector::Capacity() const noexcept {
+    return words_.Capacity() * WORD_BITS;
+}
+
+inline const uint64_t* BitVector::Data() const noexcept {
+    return words_.begin();
+}
+
+inline size_t BitVector::WordCount() const noexcept {
+    return words_.Size();
+}
+
+inline void BitVector::Reserve(size_t new_capacity) {
+    words_.Reserve(WordsFor(new_capacity));
+}
+
+inline void BitVector::Resize(size_t new_size, bool value) {
+    ranked_ = false;
+    if (new_size <= size_) {
+        words_.Resize(WordsFor(new_size));
+        size_ = new_size;
+        ClearPadding();
+        return;
+    }
+    const size_t old_size = size_;
+    words_.Resize(WordsFor(new_size));
+    size_ = new_size;
+    if (value) {
+        // rest of the old last word, then whole words
+        if (old_size % WORD_BITS != 0) {
+            words_[old_size / WORD_BITS] |= ~uint64_t(0) << (old_size % WORD_BITS);
+        }
+        std::fill(words_.begin() + WordsFor(old_size), words_.end(), ~uint64_t(0));
+        ClearPadding();
+    }
+}
+
+inline void BitVector::PushBack(bool value) {
+    if (size_ % WORD_BITS == 0) {
+        words_.PushBack(0);
+    }
+    ++size_;
+    Set(size_ - 1, value);
+}
+
+inline void BitVector::PopBack() noexcept {
+    if (size_ == 0) {
+        return;
+    }
+    Set(size_ - 1, false);
+    --size_;
+    if (size_ % WORD_BITS == 0) {
+        words_.PopBack();
+    }
+}
+
+inline void BitVector::Clear() noexcept {
+    words_.Clear();
+    size_ = 0;
+    ranked_ = false;
+}
+
+inline void BitVector::Set(size_t index, bool value) noexcept {
+    assert(index < size_);
+    const uint64_t bit = uint64_t(1) << (index % WORD_BITS);
+    uint64_t& word = words_[index / WORD_BITS];
+    word = value ? word | bit : word & ~bit;
+    ranked_ = false;
+}
+
+inline void BitVector::Flip(size_t index) noexcept {
+    assert(index < size_);
+    words_[index / WORD_BITS] ^= uint64_t(1) << (index % WORD_BITS);
+    ranked_ = false;
+}
+
+inline void BitVector::Swap(BitVector& other) noexcept {
+    words_.Swap(other.words_);
+    std::swap(size_, other.size_);
+    superblock_ranks_.Swap(other.superblock_ranks_);
+    block_ranks_.Swap(other.block_ranks_);
+    std::swap(ranked_, other.ranked_);
+}
+
+inline size_t BitVector::PopCount() const noexcept {
+    size_t count = 0;
+    for (uint64_t word : words_) {
+        count += PopCount(word);
+    }
+    return count;
+}
+
+inline size_t BitVector::FindFirst(bool value) const noexcept {
+    return FindFrom(0, value);
+}
+
+inline size_t BitVector::FindNext(size_t index, bool value) const noexcept {
+    return FindFrom(index + 1, value);
+}
+
+// plain word loops, compilers vectorize them
+
+inline void BitVector::And(const BitVector& other) {
+    CheckSameSize(other);
+    for (size_t i = 0; i < words_.Size(); ++i) {
+        words_[i] &= other.words_[i];
+    }
+    ranked_ = false;
+}
+
+inline void BitVector::Or(const BitVector& other) {
+    CheckSameSize(other);
+    for (size_t i = 0; i < words_.Size(); ++i) {
+        words_[i] |= other.words_[i];
+    }
+    ranked_ = false;
+}
+
+inline void BitVector::Xor(const BitVector& other) {
+    CheckSameSize(other);
+    for (size_t i = 0; i < words_.Size(); ++i) {
+        words_[i] ^= other.words_[i];
+    }
+    ranked_ = false;
+}
+
+inline void BitVector::AndNot(const BitVector& other) {
+    CheckSameSize(other);
+    for (size_t i = 0; i < words_.Size(); ++i) {
+        words_[i] &= ~other.words_[i];
+    }
+    ranked_ = false;
+}
+
+inline void BitVector::BuildRankIndex() {
+    const size_t words = words_.Size();
+    superblock_ranks_.Resize(words / SUPERBLOCK_WORDS + 1);
+    block_ranks_.Resize(words / BLOCK_WORDS + 1);
+    size_t total = 0;
+    size_t in_superblock = 0;
+    for (size_t word = 0; word <= words; ++word) {
+        if (word % SUPERBLOCK_WORDS == 0) {
+            superblock_ranks_[word / SUPERBLOCK_WORDS] = total;
+            in_superblock = 0;
+        }
+        if (word % BLOCK_WORDS == 0) {
+            block_ranks_[word / BLOCK_WORDS] = static_cast<uint16_t>(in_superblock);
+        }
+        if (word < words) {
+            const size_t count = PopCount(words_[word]);
+            total += count;
+            in_superblock += count;
+        }
+    }
+    ranked_ = true;
+}
+
+inline size_t BitVector::Rank(size_t index) const noexcept {
+    assert(ranked_ && "BuildRankIndex() after last change");
+    assert(index <= size_);
+    const size_t word = index / WORD_BITS;
+    size_t rank = superblock_ranks_[word / SUPERBLOCK_WORDS] + block_ranks_[word / BLOCK_WORDS];
+    for (size_t i = word / BLOCK_WORDS * BLOCK_WORDS; i < word; ++i) {
+        rank += PopCount(words_[i]);
+    }
+    if (index % WORD_BITS != 0) {
+        rank += PopCount(words_[word] & ~(~uint64_t(0) << (index % WORD_BITS)));
+    }
+    return rank;
+}
+
+inline size_t BitVector::Select(size_t rank) const noexcept {
+    assert(ranked_ && "BuildRankIndex() after last change");
+    // last superblock with fewer ones before it than rank + 1
+    size_t low = 0;
+    size_t high = superblock_ranks_.Size();
+    while (high - low > 1) {
+        const size_t middle = (low + high) / 2;
+        if (superblock_ranks_[middle] <= rank) {
+            low = middle;
+        }
+        else {
+            high = middle;
+        }
+    }
+    rank -= superblock_ranks_[low];
+
+    // then block within superblock, then word
+    size_t block = low * (SUPERBLOCK_WORDS / BLOCK_WORDS);
+    const size_t blocks_end = std::min(block_ranks_.Size(), block + SUPERBLOCK_WORDS / BLOCK_WORDS);
+    while (block + 1 < blocks_end && block_ranks_[block + 1] <= rank) {
+        ++block;
+    }
+    rank -= block_ranks_[block];
+    const size_t words_end = std::min(words_.Size(), (block + 1) * BLOCK_WORDS);
+    for (size_t word = block * BLOCK_WORDS; word < words_end; ++word) {
+        const size_t count = PopCount(words_[word]);
+        if (rank < count) {
+            return word * WORD_BITS + SelectInWord(words_[word], rank);
+        }
+        rank -= count;
+    }
+    return size_;
+}
+
+inline size_t BitVector::WordsFor(size_t bits) noexcept {
+    return (bits + WORD_BITS - 1) / WORD_BITS;
+}
+
+inline size_t BitVector::PopCount(uint64_t word) noexcept {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_popcountll(word));
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<size_t>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+inline size_t BitVector::CountTrailingZeros(uint64_t word) noexcept {
+    assert(word != 0);
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(word));
+#else
+    size_t bit = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+inline size_t BitVector::SelectInWord(uint64_t word, size_t rank) noexcept {
+#if defined(__BMI2__)
+    // deposit single bit at position of wanted one
+    return CountTrailingZeros(_pdep_u64(uint64_t(1) << rank, word));
+#else
+    for (; rank != 0; --rank) {
+        word &= word - 1;
+    }
+    return CountTrailingZeros(word);
+#endif
+}
+
+inline void BitVector::ClearPadding() noexcept {
+    if (size_ % WORD_BITS != 0) {
+        words_[size_ / WORD_BITS] &= ~(~uint64_t(0) << (size_ % WORD_BITS));
+    }
+}
+
+inline void BitVector::CheckSameSize(const BitVector& other) const {
+    if (size_ != other.size_) {
+        throw std::invalid_argument("BitVector: sizes differ");
+    }
+}
+
+inline size_t BitVector::FindFrom(size_t index, bool value) const noexcept {
+    if (index >= size_) {
+        return size_;
+    }
+    // words without wanted bit are skipped whole
+    const uint64_t flip = value ? 0 : ~uint64_t(0);
+    size_t word = index / WORD_BITS;
+    uint64_t bits = (words_[word] ^ flip) & (~uint64_t(0) << (index % WORD_BITS));
+    while (bits == 0) {
+        if (++word == words_.Size()) {
+            return size_;
+        }
+        bits = words_[word] ^ flip;
+    }
+    // zeros of padding can match value false
+    return std::min(size_, word * WORD_BITS + CountTrailingZeros(bits));
+}
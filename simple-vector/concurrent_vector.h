@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+// append-only vector for many writer threads:
+//     segment k holds FIRST_SEGMENT << k elements and is never moved,
+//     PushBack claims a slot by fetch_add, thread claiming first slot of segment k
+//     publishes segment k + 1 ahead, so others rarely find their segment missing,
+//     thread that still does publishes it by compare-exchange (loser frees its copy)
+// Size() counts claimed slots: ones being constructed, ones whose constructor threw
+// and ones whose segment failed to allocate included;
+// IsConstructed(index) tells elements safe to read from any thread, iterate as
+//     for (size_t i = 0; i < v.Size(); ++i) if (v.IsConstructed(i)) use(v[i]);
+template <typename T>
+class ConcurrentVector {
+public:         // types
+    static constexpr size_t FIRST_SEGMENT_LOG = 3;
+    static constexpr size_t FIRST_SEGMENT = size_t(1) << FIRST_SEGMENT_LOG;
+    static constexpr size_t MAX_SEGMENTS = sizeof(size_t) * 8 - FIRST_SEGMENT_LOG;
+
+private:        // fields
+    std::atomic<size_t> size_{ 0 };
+    std::atomic<T*> segments_[MAX_SEGMENTS] = {};
+    // owners of published segments, written once by the publishing thread
+    RawMemory<T> storage_[MAX_SEGMENTS];
+    // bit per constructed slot, published before its segment
+    std::atomic<std::atomic<uint64_t>*> constructed_bits_[MAX_SEGMENTS] = {};
+    std::unique_ptr<std::atomic<uint64_t>[]> constructed_storage_[MAX_SEGMENTS];
+
+public:         // constructors
+    ConcurrentVector() = default;
+    explicit ConcurrentVector(size_t capacity);
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector(ConcurrentVector&&) = delete;
+
+    ~ConcurrentVector();
+
+public:         // operators
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(ConcurrentVector&&) = delete;
+
+    const T& operator[](size_t index) const noexcept;
+    T& operator[](size_t index) noexcept;
+
+public:         // methods
+    size_t Size() const noexcept;
+    // index < Size(), false while constructor runs or after it threw
+    bool IsConstructed(size_t index) const noexcept;
+    // elements in published segments
+    size_t Capacity() const noexcept;
+    // publishes segments up to capacity, thread safe
+    void Reserve(size_t capacity);
+
+    // thread safe, returns index of new element
+    size_t PushBack(const T& value);
+    size_t PushBack(T&& value);
+    template <typename... Args>
+    size_t EmplaceBack(Args&&... args);
+
+private:        // methods
+    static size_t SegmentOf(size_t index) noexcept;
+    static size_t SegmentBegin(size_t segment) noexcept;
+    static size_t SegmentSize(size_t segment) noexcept;
+    T* GetSegment(size_t segment);
+    void PublishConstructedBits(size_t segment);
+    void MarkConstructed(size_t index) noexcept;
+    T* Slot(size_t index) const noexcept;
+};
+
+template <typename T>
+inline ConcurrentVector<T>::ConcurrentVector(size_t capacity) {
+    Reserve(capacity);
+}
+
+template <typename T>
+inline ConcurrentVector<T>::~ConcurrentVector() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        const size_t size = size_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < size; ++i) {
+            if (IsConstructed(i)) {
+                std::destroy_at(Slot(i));
+            }
+        }
+    }
+}
+
+template <typename T>
+inline const T& ConcurrentVector<T>::operator[](size_t index) const noexcept {
+    assert(index < Size());
+    return *Slot(index);
+}
+
+template <typename T>
+inline T& ConcurrentVector<T>::operator[](size_t index) noexcept {
+    assert(index < Size());
+    return *Slot(index);
+}
+
+template <typename T>
+inline size_t ConcurrentVector<T>::Size() const noexcept {
+    // elements are published by their constructed bits
+    return size_.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+inline bool ConcurrentVector<T>::IsConstructed(size_t index) const noexcept {
+    const size_t segment = SegmentOf(index);
+    if (segments_[segment].load(std::memory_order_acquire) == nullptr) {
+        return false;
+    }
+    const size_t offset = index - SegmentBegin(segment);
+    return (constructed_bits_[segment].load(std::memory_order_relaxed)[offset / 64].load(std::memory_order_acquire)
+        >> (offset % 64)) & 1;
+}
+
+template <typename T>
+inline size_t ConcurrentVector<T>::Capacity() const noexcept {
+    size_t segment = 0;
+    while (segment < MAX_SEGMENTS && segments_[segment].load(std::memory_order_acquire) != nullptr) {
+        ++segment;
+    }
+    return SegmentBegin(segment);
+}
+
+template <typename T>
+inline void ConcurrentVector<T>::Reserve(size_t capacity) {
+    if (capacity == 0) {
+        return;
+    }
+    for (size_t segment = 0; segment <= SegmentOf(capacity - 1); ++segment) {
+        GetSegment(segment);
+    }
+}
+
+template <typename T>
+inline size_t ConcurrentVector<T>::PushBack(const T& value) {
+    return EmplaceBack(value);
+}
+
+template <typename T>
+inline size_t ConcurrentVector<T>::PushBack(T&& value) {
+    return EmplaceBack(std::move(value));
+}
+
+template <typename T>
+template <typename... Args>
+inline size_t ConcurrentVector<T>::EmplaceBack(Args&&... args) {
+    const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+    const size_t segment = SegmentOf(index);
+    if (index == SegmentBegin(segment) && segment + 1 < MAX_SEGMENTS) {
+        try {
+            GetSegment(segment + 1);
+        }
+        catch (const std::bad_alloc&) {
+            // claimants of segment + 1 retry
+        }
+    }
+    // on throw slot stays claimed and never gets constructed bit
+    T* data = GetSegment(segment);
+    new (data + (index - SegmentBegin(segment))) T(std::forward<Args>(args)...);
+    MarkConstructed(index);
+    return index;
+}
+
+template <typename T>
+inline size_t ConcurrentVector<T>::SegmentOf(size_t index) noexcept {
+    // segment k covers [FIRST_SEGMENT * (2^k - 1), FIRST_SEGMENT * (2^(k + 1) - 1))
+    size_t biased = (index >> FIRST_SEGMENT_LOG) + 1;
+#if defined(__GNUC__)
+    return sizeof(unsigned long long) * 8 - 1 - static_cast<size_t>(__builtin_clzll(biased));
+#else
+    size_t segment = 0;
+    while (biased >>= 1) {
+        ++segment;
+    }
+    return segment;
+#endif
+}
+
+template <typename T>
+inline size_t ConcurrentVector<T>::SegmentBegin(size_t segment) noexcept {
+    return FIRST_SEGMENT * ((size_t(1) << segment) - 1);
+}
+
+template <typename T>
+inline size_t ConcurrentVector<T>::SegmentSize(size_t segment) noexcept {
+    return FIRST_SEGMENT << segment;
+}
+
+template <typename T>
+inline T* ConcurrentVector<T>::GetSegment(size_t segment) {
+    T* published = segments_[segment].load(std::memory_order_acquire);
+    if (published != nullptr) {
+        return published;
+    }
+    PublishConstructedBits(segment);
+    RawMemory<T> memory(SegmentSize(segment));
+    T* address = memory.GetAddress();
+    if (segments_[segment].compare_exchange_strong(published, address,
+        std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        storage_[segment] = std::move(memory);
+        return address;
+    }
+    // other thread won, memory is freed
+    return published;
+}
+
+template <typename T>
+inline void ConcurrentVector<T>::PublishConstructedBits(size_t segment) {
+    if (constructed_bits_[segment].load(std::memory_order_acquire) != nullptr) {
+        return;
+    }
+    // zeroed words
+    std::unique_ptr<std::atomic<uint64_t>[]> bits(new std::atomic<uint64_t>[(SegmentSize(segment) + 63) / 64]());
+    std::atomic<uint64_t>* published = nullptr;
+    if (constructed_bits_[segment].compare_exchange_strong(published, bits.get(),
+        std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        constructed_storage_[segment] = std::move(bits);
+    }
+}
+
+template <typename T>
+inline void ConcurrentVector<T>::MarkConstructed(size_t index) noexcept {
+    const size_t segment = SegmentOf(index);
+    const size_t offset = index - SegmentBegin(segment);
+    constructed_bits_[segment].load(std::memory_order_acquire)[offset / 64].fetch_or(
+        uint64_t(1) << (offset % 64), std::memory_order_release);
+}
+
+template <typename T>
+inline T* ConcurrentVector<T>::Slot(size_t index) const noexcept {
+    const size_t segment = SegmentOf(index);
+    return segments_[segment].load(std::memory_order_acquire) + (index - SegmentBegin(segment));
+}
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.h"
+
+// copy-on-write vector: copies share one block, the first mutation of a shared block clones it;
+// reference count lives in a header right before the elements, so Size, operator[] and
+// iteration cost the same as in Vector
+//     CowVector<Route> routes = table;    // no element copied
+//     routes.PushBack(extra);             // routes gets its own block here
+// read access is const only: a non-const T& into a shared block would leak writes into
+// other copies; Mutable(index) unshares first and returns a reference valid until next copy
+// copies may be used and destroyed in different threads (count is atomic), one object may not
+template <typename T>
+class CowVector {
+private:        // types
+    struct Header {
+        std::atomic<size_t> refs;
+        size_t capacity;
+    };
+
+    static constexpr size_t BLOCK_ALIGN = std::max(alignof(Header), alignof(T));
+    // elements start right after header, at their own alignment
+    static constexpr size_t HEADER_BYTES = (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    // allocation unit of blocks
+    struct alignas(BLOCK_ALIGN) Unit {
+        unsigned char bytes[BLOCK_ALIGN];
+    };
+
+private:        // fields
+    T* data_ = nullptr;     // elements of block, nullptr without block
+    size_t size_ = 0;       // equal in all copies: shared blocks never change
+
+public:         // constructors
+    CowVector() = default;
+    explicit CowVector(size_t size);
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    CowVector(InputIt first, InputIt last);
+    // shares other's block
+    CowVector(const CowVector& other) noexcept;
+    CowVector(CowVector&& other) noexcept;
+    ~CowVector();
+
+public:         // iterators
+    using iterator = const T*;
+    using const_iterator = const T*;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+public:         // operators
+    const T& operator[](size_t index) const noexcept;
+
+    CowVector& operator=(const CowVector& other) noexcept;
+    CowVector& operator=(CowVector&& other) noexcept;
+
+public:         // methods
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+    const T* Data() const noexcept;
+    // number of CowVectors sharing block, 0 without block
+    size_t UseCount() const noexcept;
+    // clones shared block, so elements can change
+    T& Mutable(size_t index);
+    T* MutableData();
+    void Reserve(size_t new_capacity);
+    void Swap(CowVector& other) noexcept;
+    void Resize(size_t new_size);
+    void PopBack() /* noexcept */;
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+    // drops reference to shared block, destroys elements of own one
+    void Clear() noexcept;
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+private:        // methods
+    static Header* HeaderOf(T* data) noexcept;
+    static T* AllocateBlock(size_t capacity);
+    static void DeallocateBlock(T* data) noexcept;
+
+    bool IsUnique() const noexcept;
+    // gives own block to *this, keeps capacity
+    void Detach();
+    // moves (own block) or copies (shared block) elements to new block
+    void Reallocate(size_t new_capacity);
+    void Release() noexcept;
+};
+
+template <typename T>
+inline CowVector<T>::CowVector(size_t size) {
+    // destructor doesn't run if constructor throws
+    try {
+        Resize(size);
+    }
+    catch (...) {
+        Release();
+        throw;
+    }
+}
+
+template <typename T>
+template <typename InputIt, typename>
+inline CowVector<T>::CowVector(InputIt first, InputIt last) {
+    try {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+            Reserve(std::distance(first, last));
+        }
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+    catch (...) {
+        Release();
+        throw;
+    }
+}
+
+template <typename T>
+inline CowVector<T>::CowVector(const CowVector& other) noexcept
+    : data_(other.data_)
+    , size_(other.size_) {
+    if (data_ != nullptr) {
+        HeaderOf(data_)->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+inline CowVector<T>::CowVector(CowVector&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0)) {
+}
+
+template <typename T>
+inline CowVector<T>::~CowVector() {
+    Release();
+}
+
+template <typename T>
+inline typename CowVector<T>::const_iterator CowVector<T>::begin() const noexcept {
+    return data_;
+}
+
+template <typename T>
+inline typename CowVector<T>::const_iterator CowVector<T>::end() const noexcept {
+    return data_ + size_;
+}
+
+template <typename T>
+inline typename CowVector<T>::const_iterator CowVector<T>::cbegin() const noexcept {
+    return begin();
+}
+
+template <typename T>
+inline typename CowVector<T>::const_iterator CowVector<T>::cend() const noexcept {
+    return end();
+}
+
+template <typename T>
+inline const T& CowVector<T>::operator[](size_t index) const noexcept {
+    assert(index < size_);
+    return data_[index];
+}
+
+template <typename T>
+inline CowVector<T>& CowVector<T>::operator=(const CowVector& other) noexcept {
+    if (this != &other) {
+        CowVector copy(other);
+        Swap(copy);
+    }
+    return *this;
+}
+
+template <typename T>
+inline CowVector<T>& CowVector<T>::operator=(CowVector&& other) noexcept {
+    if (this != &other) {
+        Release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+template <typename T>
+inline size_t CowVector<T>::Size() const noexcept {
+    return size_;
+}
+
+template <typename T>
+inline size_t CowVector<T>::Capacity() const noexcept {
+    return data_ == nullptr ? 0 : HeaderOf(data_)->capacity;
+}
+
+template <typename T>
+inline const T* CowVector<T>::Data() const noexcept {
+    return data_;
+}
+
+template <typename T>
+inline size_t CowVector<T>::UseCount() const noexcept {
+    return data_ == nullptr ? 0 : HeaderOf(data_)->refs.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+inline T& CowVector<T>::Mutable(size_t index) {
+    assert(index < size_);
+    Detach();
+    return data_[index];
+}
+
+template <typename T>
+inline T* CowVector<T>::MutableData() {
+    Detach();
+    return data_;
+}
+
+template <typename T>
+inline void CowVector<T>::Reserve(size_t new_capacity) {
+    if (new_capacity <= Capacity()) {
+        return;
+    }
+    Reallocate(new_capacity);
+}
+
+template <typename T>
+inline void CowVector<T>::Swap(CowVector& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+}
+
+template <typename T>
+inline void CowVector<T>::Resize(size_t new_size) {
+    if (new_size == size_) {
+        return;
+    }
+    if (new_size > Capacity()) {
+        Reallocate(DoublingGrowth::Grow(Capacity(), new_size, sizeof(T)));
+    }
+    else {
+        Detach();
+    }
+    if (new_size > size_) {
+        std::uninitialized_value_construct_n(data_ + size_, new_size - size_);
+    }
+    else {
+        std::destroy_n(data_ + new_size, size_ - new_size);
+    }
+    size_ = new_size;
+}
+
+template <typename T>
+inline void CowVector<T>::PopBack() {
+    if (size_ == 0) {
+        return;
+    }
+    Detach();
+    --size_;
+    std::destroy_at(data_ + size_);
+}
+
+template <typename T>
+inline void CowVector<T>::PushBack(const T& value) {
+    EmplaceBack(value);
+}
+
+template <typename T>
+inline void CowVector<T>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+}
+
+template <typename T>
+inline void CowVector<T>::Clear() noexcept {
+    if (IsUnique()) {
+        std::destroy_n(data_, size_);
+    }
+    else {
+        Release();
+        data_ = nullptr;
+    }
+    size_ = 0;
+}
+
+template <typename T>
+template <typename... Args>
+inline T& CowVector<T>::EmplaceBack(Args&&... args) {
+    if (size_ == Capacity() || !IsUnique()) {
+        // args may refer to an element: take it before elements move
+        T value(std::forward<Args>(args)...);
+        Reallocate(size_ == Capacity() ? DoublingGrowth::Grow(Capacity(), size_ + 1, sizeof(T)) : Capacity());
+        new (data_ + size_) T(std::move(value));
+    }
+    else {
+        new (data_ + size_) T(std::forward<Args>(args)...);
+    }
+    return data_[size_++];
+}
+
+template <typename T>
+inline typename CowVector<T>::Header* CowVector<T>::HeaderOf(T* data) noexcept {
+    return reinterpret_cast<Header*>(reinterpret_cast<unsigned char*>(data) - HEADER_BYTES);
+}
+
+template <typename T>
+inline T* CowVector<T>::AllocateBlock(size_t capacity) {
+    if (capacity > (SIZE_MAX - HEADER_BYTES) / sizeof(T)) {
+        throw std::length_error("CowVector: capacity is too large");
+    }
+    const size_t units = (HEADER_BYTES + capacity * sizeof(T) + sizeof(Unit) - 1) / sizeof(Unit);
+    Unit* block = std::allocator<Unit>().allocate(units);
+    new (block) Header{ { 1 }, capacity };
+    return reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(block) + HEADER_BYTES);
+}
+
+template <typename T>
+inline void CowVector<T>::DeallocateBlock(T* data) noexcept {
+    Header* header = HeaderOf(data);
+    const size_t units = (HEADER_BYTES + header->capacity * sizeof(T) + sizeof(Unit) - 1) / sizeof(Unit);
+    header->~Header();
+    std::allocator<Unit>().deallocate(reinterpret_cast<Unit*>(header), units);
+}
+
+template <typename T>
+inline bool CowVector<T>::IsUnique() const noexcept {
+    // acquire: reads of elements by released copies happen before our writes
+    return data_ != nullptr && HeaderOf(data_)->refs.load(std::memory_order_acquire) == 1;
+}
+
+template <typename T>
+inline void CowVector<T>::Detach() {
+    if (data_ != nullptr && !IsUnique()) {
+        Reallocate(Capacity());
+    }
+}
+
+template <typename T>
+inline void CowVector<T>::Reallocate(size_t new_capacity) {
+    T* fresh = AllocateBlock(new_capacity);
+    const bool unique = IsUnique();
+    try {
+        if (unique) {
+            UninitializedRelocateN(data_, size_, fresh);
+        }
+        else {
+            std::uninitialized_copy_n(data_, size_, fresh);
+        }
+    }
+    catch (...) {
+        DeallocateBlock(fresh);
+        throw;
+    }
+    if (unique) {
+        // elements are relocated, block goes without destroying them
+        DeallocateBlock(data_);
+    }
+    else {
+        Release();
+    }
+    data_ = fresh;
+}
+
+template <typename T>
+inline void CowVector<T>::Release() noexcept {
+    if (data_ != nullptr && HeaderOf(data_)->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::destroy_n(data_, size_);
+        DeallocateBlock(data_);
+    }
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+#include <sys/mman.h>
+
+#include "vector.h"
+
+// how HugePageAllocator gets huge pages for big blocks
+enum class HugePageMode {
+    ADVISE,     // 2 MiB aligned mapping + madvise(MADV_HUGEPAGE), transparent huge pages
+    EXPLICIT,   // MAP_HUGETLB from reserved pool, falls back to ADVISE if pool is empty
+};
+
+// allocator for big buffers with random access:
+// blocks from threshold bytes are 2 MiB aligned and backed by huge pages (Linux only),
+// smaller blocks come from operator new
+template <typename T>
+class HugePageAllocator {
+private:        // fields
+    size_t threshold_;
+    HugePageMode mode_;
+
+public:         // types
+    using value_type = T;
+
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+public:         // constructors
+    explicit HugePageAllocator(size_t threshold = HUGE_PAGE_SIZE,
+        HugePageMode mode = HugePageMode::ADVISE) noexcept;
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>& other) noexcept;
+
+public:         // methods
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n) noexcept;
+    size_t Threshold() const noexcept;
+    HugePageMode Mode() const noexcept;
+
+private:        // methods
+    bool IsHuge(size_t bytes) const noexcept;
+    static size_t HugeRound(size_t bytes) noexcept;
+    static void* MapExplicit(size_t length) noexcept;
+    static void* MapAdvised(size_t length) noexcept;
+};
+
+template <typename T, typename U>
+bool operator==(const HugePageAllocator<T>& lhs, const HugePageAllocator<U>& rhs) noexcept;
+template <typename T, typename U>
+bool operator!=(const HugePageAllocator<T>& lhs, const HugePageAllocator<U>& rhs) noexcept;
+
+// vector for large lookup tables
+template <typename T>
+using HugePageVector = Vector<T, HugePageAllocator<T>>;
+
+template <typename T>
+inline HugePageAllocator<T>::HugePageAllocator(size_t threshold, HugePageMode mode) noexcept
+    : threshold_(threshold)
+    , mode_(mode) { }
+
+template <typename T>
+template <typename U>
+inline HugePageAllocator<T>::HugePageAllocator(const HugePageAllocator<U>& other) noexcept
+    : threshold_(other.Threshold())
+    , mode_(other.Mode()) { }
+
+template <typename T>
+inline T* HugePageAllocator<T>::allocate(size_t n) {
+    const size_t bytes = n * sizeof(T);
+    if (!IsHuge(bytes)) {
+        return std::allocator<T>().allocate(n);
+    }
+    const size_t length = HugeRound(bytes);
+    void* p = nullptr;
+    if (mode_ == HugePageMode::EXPLICIT) {
+        p = MapExplicit(length);
+    }
+    if (p == nullptr) {
+        p = MapAdvised(length);
+    }
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return static_cast<T*>(p);
+}
+
+template <typename T>
+inline void HugePageAllocator<T>::deallocate(T* p, size_t n) noexcept {
+    const size_t bytes = n * sizeof(T);
+    if (!IsHuge(bytes)) {
+        std::allocator<T>().deallocate(p, n);
+        return;
+    }
+    // both kinds of mapping are exactly HugeRound(bytes) long
+    munmap(p, HugeRound(bytes));
+}
+
+template <typename T>
+inline size_t HugePageAllocator<T>::Threshold() const noexcept {
+    return threshold_;
+}
+
+template <typename T>
+inline HugePageMode HugePageAllocator<T>::Mode() const noexcept {
+    return mode_;
+}
+
+template <typename T>
+inline bool HugePageAllocator<T>::IsHuge(size_t bytes) const noexcept {
+    return bytes >= threshold_;
+}
+
+template <typename T>
+inline size_t HugePageAllocator<T>::HugeRound(size_t bytes) noexcept {
+    return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+template <typename T>
+inline void* HugePageAllocator<T>::MapExplicit(size_t length) noexcept {
+#ifdef MAP_HUGETLB
+    void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return p != MAP_FAILED ? p : nullptr;
+#else
+    (void)length;
+    return nullptr;
+#endif
+}
+
+template <typename T>
+inline void* HugePageAllocator<T>::MapAdvised(size_t length) noexcept {
+    // over-map by one huge page and trim both ends to get 2 MiB alignment
+    const size_t mapped = length + HUGE_PAGE_SIZE;
+    void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        return nullptr;
+    }
+    char* begin = static_cast<char*>(p);
+    char* aligned = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(begin) + HUGE_PAGE_SIZE - 1) & ~(uintptr_t(HUGE_PAGE_SIZE) - 1));
+    if (aligned != begin) {
+        munmap(begin, aligned - begin);
+    }
+    char* end = aligned + length;
+    if (end != begin + mapped) {
+        munmap(end, begin + mapped - end);
+    }
+#ifdef MADV_HUGEPAGE
+    // only a hint: THP may be disabled system-wide
+    madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+
+template <typename T, typename U>
+inline bool operator==(const HugePageAllocator<T>& lhs, const HugePageAllocator<U>& rhs) noexcept {
+    return lhs.Threshold() == rhs.Threshold() && lhs.Mode() == rhs.Mode();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const HugePageAllocator<T>& lhs, const HugePageAllocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
@@ -76,4 +76,76 @@ int main() {
     catch (...) {
         assert(false);
     }
+
+    // allocator tests
+    TestPmrVector();
+    TestArenaVector();
+    TestRemapVector();
+    TestStableVector();
+    TestHugePageVector();
+    TestAlignedVector();
+
+    // small vector tests
+    TestSmallVector();
+
+    // relocation tests
+    TestTriviallyRelocatable();
+
+    // growth policy tests
+    TestGrowthPolicy();
+
+    // range operation tests
+    TestRangeOperations();
+
+    // erase tests
+    TestEraseOperations();
+
+    // default-init tests
+    TestDefaultInit();
+
+    // shrink tests
+    TestShrink();
+
+    // bulk copy tests
+    TestTrivialCopy();
+
+    // concurrent vector tests
+    TestConcurrentVector();
+    BenchmarkConcurrentVector();
+
+    // segmented vector tests
+    TestSegmentedVector();
+
+    // parallel algorithm tests
+    TestParallelAlgorithms();
+
+    // work stealing tests
+    TestWorkStealing();
+    BenchmarkWorkStealing();
+
+    // simd tests
+    TestSimdKernels();
+
+    // structure of arrays tests
+    TestSoaVector();
+    BenchmarkSoaVector();
+
+    // copy-on-write tests
+    TestCowVector();
+    BenchmarkCowVector();
+
+    // persistent vector tests
+    TestPersistentVector();
+
+    // bit vector tests
+    TestBitVector();
+    BenchmarkBitVector();
+
+    // packed integer tests
+    TestPackedIntVector();
+    BenchmarkPackedIntVector();
+
+    // serialization tests
+    TestVectorIo();
+    BenchmarkVectorIo();
 }
\ No newline at end of file
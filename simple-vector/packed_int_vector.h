@@ -0,0 +1,361 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+// read-only compressed unsigned integers (ids, timestamps, posting lists)
+// values go in blocks of BLOCK, each block packed in the least bit width that fits it, either
+//     frame of reference: every value minus block minimum, or
+//     delta: every value minus value LANES before it (first LANES minus block minimum),
+//     if no value is less than that one; taken when it needs fewer bits
+// last Size() % BLOCK values wait uncompressed in a tail until their block is full
+//     PackedIntVector<uint32_t> ids(posting_list);    // gaps up to 16: 7 bits per id, 4.5x smaller
+//     ids.Append(next_id);
+//     ids.ForEach([&](uint32_t id) { ... });          // whole blocks decoded at a time
+// a block is LANES bit streams with words interleaved, value i in stream i % LANES: decoding
+// does the same shift in all lanes and sums deltas per lane, DecodeBlock is unrolled per width
+// with constant shifts and compilers vectorize it; Get(index) reads two words per value, so up
+// to BLOCK / LANES deltas in delta blocks
+template <typename T>
+class PackedIntVector {
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T>, "PackedIntVector holds unsigned integers");
+
+public:         // types
+    static constexpr size_t BLOCK = 128;
+
+private:        // types
+    static constexpr size_t BITS = sizeof(T) * 8;
+    // words as wide as values, at least unsigned: LANES uint32_t lanes fill a 16-byte register
+    using Word = std::conditional_t<(sizeof(T) < sizeof(unsigned)), unsigned, T>;
+    static constexpr size_t WORD_BITS = sizeof(Word) * 8;
+    static constexpr size_t LANES = 4;
+    static constexpr size_t LANE_VALUES = BLOCK / LANES;
+    // zero words after last block: reads of next word of lane stay inside, also for width 0
+    static constexpr size_t PADDING = 2 * LANES;
+
+    struct Block {
+        size_t offset;      // first word in words_, block takes BlockWords(width) words
+        T base;             // minimum
+        uint8_t width;      // bits per packed value
+        bool delta;         // packed values are deltas, not values minus base
+    };
+
+    // writes values of block: base plus packed value, or base plus deltas of lane so far
+    using Unpacker = void (*)(const Word* words, T base, bool delta, T* out) noexcept;
+
+private:        // fields
+    Vector<Block> blocks_;
+    // packed blocks and PADDING zero words
+    Vector<Word> words_ = Vector<Word>(PADDING);
+    Vector<T> tail_;
+
+public:         // constructors
+    PackedIntVector() = default;
+    template <typename Alloc, typename Growth>
+    explicit PackedIntVector(const Vector<T, Alloc, Growth>& values);
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    PackedIntVector(InputIt first, InputIt last);
+
+public:         // operators
+    T operator[](size_t index) const noexcept;
+
+public:         // methods
+    size_t Size() const noexcept;
+    // full blocks and tail
+    size_t BlockCount() const noexcept;
+    // heap bytes of blocks, packed words and tail
+    size_t MemoryBytes() const noexcept;
+    T Get(size_t index) const noexcept;
+    void Append(T value);
+    template <typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void Append(InputIt first, InputIt last);
+    // writes values of block number block to out[0, BLOCK), returns their count (less for tail)
+    size_t DecodeBlock(size_t block, T* out) const noexcept;
+    // calls f(value) for values in order
+    template <typename F>
+    void ForEach(F f) const;
+    Vector<T> ToVector() const;
+    void ShrinkToFit();
+    void Swap(PackedIntVector& other) noexcept;
+    void Clear() noexcept;
+
+private:        // methods
+    static size_t BlockWords(size_t width) noexcept;
+    static uint64_t Mask(size_t width) noexcept;
+    static size_t WidthOf(uint64_t range) noexcept;
+    // width bits from bit of lane stream, next word of lane must be readable
+    static uint64_t Extract(const Word* words, size_t lane, size_t bit, size_t width) noexcept;
+    template <size_t WIDTH>
+    static void Unpack(const Word* words, T base, bool delta, T* out) noexcept;
+    template <size_t... WIDTHS>
+    static constexpr std::array<Unpacker, BITS + 1> MakeUnpackers(std::index_sequence<WIDTHS...>) noexcept;
+
+    // packs full tail into new block
+    void SealTail();
+};
+
+template <typename T>
+template <typename Alloc, typename Growth>
+inline PackedIntVector<T>::PackedIntVector(const Vector<T, Alloc, Growth>& values)
+    : PackedIntVector(values.begin(), values.end()) {
+}
+
+template <typename T>
+template <typename InputIt, typename>
+inline PackedIntVector<T>::PackedIntVector(InputIt first, InputIt last) {
+    Append(first, last);
+}
+
+template <typename T>
+inline T PackedIntVector<T>::operator[](size_t index) const noexcept {
+    return Get(index);
+}
+
+template <typename T>
+inline size_t PackedIntVector<T>::Size() const noexcept {
+    return blocks_.Size() * BLOCK + tail_.Size();
+}
+
+template <typename T>
+inline size_t PackedIntVector<T>::BlockCount() const noexcept {
+    return blocks_.Size() + (tail_.Size() != 0 ? 1 : 0);
+}
+
+template <typename T>
+inline size_t PackedIntVector<T>::MemoryBytes() const noexcept {
+    return blocks_.Capacity() * sizeof(Block) + words_.Capacity() * sizeof(Word) + tail_.Capacity() * sizeof(T);
+}
+
+template <typename T>
+inline T PackedIntVector<T>::Get(size_t index) const noexcept {
+    assert(index < Size());
+    const size_t block_index = index / BLOCK;
+    if (block_index == blocks_.Size()) {
+        return tail_[index % BLOCK];
+    }
+    const Block& block = blocks_[block_index];
+    const Word* words = words_.begin() + block.offset;
+    const size_t position = index % BLOCK / LANES;
+    const size_t lane = index % LANES;
+    // delta block: base and all deltas of lane up to position
+    T value = block.base;
+    for (size_t i = block.delta ? 0 : position; i <= position; ++i) {
+        value += static_cast<T>(Extract(words, lane, i * block.width, block.width));
+    }
+    return value;
+}
+
+template <typename T>
+inline void PackedIntVector<T>::Append(T value) {
+    tail_.PushBack(value);
+    if (tail_.Size() == BLOCK) {
+        SealTail();
+    }
+}
+
+template <typename T>
+template <typename InputIt, typename>
+inline void PackedIntVector<T>::Append(InputIt first, InputIt last) {
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+        // packed words aren't reserved: their count depends on values
+        blocks_.Reserve(blocks_.Size() + (tail_.Size() + std::distance(first, last)) / BLOCK);
+    }
+    for (; first != last; ++first) {
+        Append(static_cast<T>(*first));
+    }
+}
+
+template <typename T>
+inline size_t PackedIntVector<T>::DecodeBlock(size_t block, T* out) const noexcept {
+    assert(block < BlockCount());
+    if (block == blocks_.Size()) {
+        std::copy(tail_.begin(), tail_.end(), out);
+        return tail_.Size();
+    }
+    static constexpr std::array<Unpacker, BITS + 1> UNPACKERS = MakeUnpackers(std::make_index_sequence<BITS + 1>());
+    const Block& packed = blocks_[block];
+    UNPACKERS[packed.width](words_.begin() + packed.offset, packed.base, packed.delta, out);
+    return BLOCK;
+}
+
+template <typename T>
+template <typename F>
+inline void PackedIntVector<T>::ForEach(F f) const {
+    T values[BLOCK];
+    // full blocks with constant count, then tail
+    for (size_t block = 0; block < blocks_.Size(); ++block) {
+        DecodeBlock(block, values);
+        for (size_t i = 0; i < BLOCK; ++i) {
+            f(values[i]);
+        }
+    }
+    for (T value : tail_) {
+        f(value);
+    }
+}
+
+template <typename T>
+inline Vector<T> PackedIntVector<T>::ToVector() const {
+    Vector<T> result;
+    result.ResizeForOverwrite(Size(), [this](T* data, size_t size) {
+        for (size_t block = 0; block < BlockCount(); ++block) {
+            DecodeBlock(block, data + block * BLOCK);
+        }
+        return size;
+    });
+    return result;
+}
+
+template <typename T>
+inline void PackedIntVector<T>::ShrinkToFit() {
+    blocks_.ShrinkToFit();
+    words_.ShrinkToFit();
+    tail_.ShrinkToFit();
+}
+
+template <typename T>
+inline void PackedIntVector<T>::Swap(PackedIntVector& other) noexcept {
+    blocks_.Swap(other.blocks_);
+    words_.Swap(other.words_);
+    tail_.Swap(other.tail_);
+}
+
+template <typename T>
+inline void PackedIntVector<T>::Clear() noexcept {
+    blocks_.Clear();
+    // keeps zero words
+    words_.Resize(PADDING);
+    std::fill(words_.begin(), words_.end(), 0);
+    tail_.Clear();
+}
+
+template <typename T>
+inline size_t PackedIntVector<T>::BlockWords(size_t width) noexcept {
+    return LANES * ((LANE_VALUES * width + WORD_BITS - 1) / WORD_BITS);
+}
+
+template <typename T>
+inline uint64_t PackedIntVector<T>::Mask(size_t width) noexcept {
+    return width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+}
+
+template <typename T>
+inline size_t PackedIntVector<T>::WidthOf(uint64_t range) noexcept {
+    size_t width = 0;
+    for (; range != 0; range >>= 1) {
+        ++width;
+    }
+    return width;
+}
+
+template <typename T>
+inline uint64_t PackedIntVector<T>::Extract(const Word* words, size_t lane, size_t bit, size_t width) noexcept {
+    const Word* low = words + bit / WORD_BITS * LANES + lane;
+    const size_t shift = bit % WORD_BITS;
+    // high part shifted in two steps: shift 64 would be undefined, and adds nothing if value fits low word
+    const uint64_t value = (uint64_t(low[0]) >> shift) | (uint64_t(low[LANES]) << 1 << (WORD_BITS - 1 - shift));
+    return value & Mask(width);
+}
+
+template <typename T>
+template <size_t WIDTH>
+inline void PackedIntVector<T>::Unpack(const Word* words, T base, bool delta, T* out) noexcept {
+    if constexpr (WIDTH == 0) {
+        std::fill(out, out + BLOCK, base);
+    }
+    else {
+        // base of every lane, or lane value at previous position for delta
+        Word sums[LANES];
+        std::fill(sums, sums + LANES, base);
+        const Word delta_mask = delta ? ~Word(0) : 0;
+        // unrolled: word, shift and mask are constants, same for all lanes
+#if defined(__GNUC__)
+#pragma GCC unroll 32
+#endif
+        for (size_t position = 0; position < LANE_VALUES; ++position) {
+            const size_t bit = position * WIDTH;
+            const size_t shift = bit % WORD_BITS;
+            const Word* low = words + bit / WORD_BITS * LANES;
+            // all lanes read before any is written: out may alias words of same type
+            Word values[LANES];
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                values[lane] = low[lane] >> shift;
+                if (shift + WIDTH > WORD_BITS) {
+                    values[lane] |= low[LANES + lane] << (WORD_BITS - shift);
+                }
+                if (WIDTH < WORD_BITS) {
+                    values[lane] &= (Word(1) << (WIDTH % WORD_BITS)) - 1;
+                }
+            }
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                out[position * LANES + lane] = static_cast<T>(sums[lane] + values[lane]);
+                sums[lane] += values[lane] & delta_mask;
+            }
+        }
+    }
+}
+
+template <typename T>
+template <size_t... WIDTHS>
+inline constexpr std::array<typename PackedIntVector<T>::Unpacker, PackedIntVector<T>::BITS + 1>
+PackedIntVector<T>::MakeUnpackers(std::index_sequence<WIDTHS...>) noexcept {
+    return { &Unpack<WIDTHS>... };
+}
+
+template <typename T>
+inline void PackedIntVector<T>::SealTail() {
+    assert(tail_.Size() == BLOCK);
+    T min = tail_[0];
+    T max = tail_[0];
+    for (T value : tail_) {
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+    }
+    // deltas of first LANES values are from min
+    bool sorted = true;
+    T max_delta = 0;
+    for (size_t i = 0; i < BLOCK; ++i) {
+        const T previous = i < LANES ? min : tail_[i - LANES];
+        sorted = sorted && tail_[i] >= previous;
+        max_delta = std::max(max_delta, static_cast<T>(tail_[i] - previous));
+    }
+    const bool delta = sorted && WidthOf(max_delta) < WidthOf(max - min);
+    const size_t width = delta ? WidthOf(max_delta) : WidthOf(max - min);
+
+    // new block starts at padding, new padding follows (moved-from object has none)
+    if (words_.Size() == 0) {
+        words_.Resize(PADDING);
+    }
+    const size_t offset = words_.Size() - PADDING;
+    words_.Resize(offset + BlockWords(width) + PADDING);
+    if (width != 0) {
+        Word* words = words_.begin() + offset;
+        for (size_t i = 0; i < BLOCK; ++i) {
+            const uint64_t value = static_cast<T>(tail_[i] - (delta && i >= LANES ? tail_[i - LANES] : min));
+            const size_t bit = i / LANES * width;
+            const size_t shift = bit % WORD_BITS;
+            Word* low = words + bit / WORD_BITS * LANES + i % LANES;
+            low[0] |= static_cast<Word>(value << shift);
+            if (shift + width > WORD_BITS) {
+                low[LANES] |= static_cast<Word>(value >> (WORD_BITS - shift));
+            }
+        }
+    }
+    try {
+        blocks_.PushBack(Block{ offset, min, static_cast<uint8_t>(width), delta });
+    }
+    catch (...) {
+        words_.Resize(offset + PADDING);
+        std::fill(words_.begin() + offset, words_.end(), 0);
+        throw;
+    }
+    tail_.Clear();
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "optional.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+// data-parallel algorithms over contiguous ranges (Vector::iterator is T*):
+// range is cut into chunks of grain elements, each chunk goes to one thread;
+// grain 0 - chunks of DEFAULT_GRAIN_BYTES, enough work per task and whole cache lines
+//     parallel::Transform(in.begin(), in.end(), out.begin(), Score);
+//     double total = parallel::Reduce(v.begin(), v.end(), 0.0, std::plus<>());
+namespace parallel {
+
+    inline constexpr size_t DEFAULT_GRAIN_BYTES = 64 * 1024;
+
+    // elements per chunk for grain argument
+    template <typename T>
+    size_t GrainFor(size_t grain) noexcept;
+
+    template <typename T, typename Function>
+    void ForEach(T* first, T* last, Function f,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    template <typename T, typename U, typename Operation>
+    U* Transform(T* first, T* last, U* out, Operation op,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    template <typename T, typename Value>
+    void Fill(T* first, T* last, const Value& value,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    // op must be associative, chunks are combined in order: init op r0 op r1 ...;
+    // like std::reduce a chunk starts from its first element, op takes T and R alike
+    template <typename T, typename R, typename Operation>
+    R Reduce(T* first, T* last, R init, Operation op,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    // fold(R, const T&) within a chunk starting from R{}, combine(R, R) joins chunk results
+    // in order, R{} must be identity of combine:
+    //     size_t chars = parallel::Reduce(words.begin(), words.end(), size_t(0),
+    //         [](size_t n, const std::string& s) { return n + s.size(); }, std::plus<>());
+    template <typename T, typename R, typename Fold, typename Combine,
+        typename = std::enable_if_t<!std::is_convertible_v<Combine, size_t>>>
+    R Reduce(T* first, T* last, R init, Fold fold, Combine combine,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    template <typename T, typename Predicate>
+    size_t CountIf(T* first, T* last, Predicate pred,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    template <typename T, typename Value>
+    size_t Count(T* first, T* last, const Value& value,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    // first match like std::find_if, chunks after a found match are skipped
+    template <typename T, typename Predicate>
+    T* FindIf(T* first, T* last, Predicate pred,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    template <typename T, typename Value>
+    T* Find(T* first, T* last, const Value& value,
+        size_t grain = 0, ThreadPool& pool = DefaultThreadPool());
+
+    template <typename T>
+    inline size_t GrainFor(size_t grain) noexcept {
+        if (grain != 0) {
+            return grain;
+        }
+        return std::max(DEFAULT_GRAIN_BYTES / sizeof(T), size_t(1));
+    }
+
+    template <typename T, typename Function>
+    inline void ForEach(T* first, T* last, Function f, size_t grain, ThreadPool& pool) {
+        pool.ParallelFor(last - first, GrainFor<T>(grain), [first, &f](size_t begin, size_t end) {
+            std::for_each(first + begin, first + end, f);
+        });
+    }
+
+    template <typename T, typename U, typename Operation>
+    inline U* Transform(T* first, T* last, U* out, Operation op, size_t grain, ThreadPool& pool) {
+        pool.ParallelFor(last - first, GrainFor<T>(grain), [first, out, &op](size_t begin, size_t end) {
+            std::transform(first + begin, first + end, out + begin, op);
+        });
+        return out + (last - first);
+    }
+
+    template <typename T, typename Value>
+    inline void Fill(T* first, T* last, const Value& value, size_t grain, ThreadPool& pool) {
+        pool.ParallelFor(last - first, GrainFor<T>(grain), [first, &value](size_t begin, size_t end) {
+            std::fill(first + begin, first + end, value);
+        });
+    }
+
+    namespace detail {
+        // start(first element) begins chunk result, fold adds the rest
+        template <typename T, typename R, typename Start, typename Fold, typename Combine>
+        inline R ReduceChunks(T* first, T* last, R init, Start& start, Fold& fold, Combine& combine,
+            size_t grain, ThreadPool& pool) {
+            const size_t count = last - first;
+            grain = GrainFor<T>(grain);
+            // one slot per chunk, empty until chunk is done: R needn't be default constructible
+            Vector<Optional<R>> partial((count + grain - 1) / grain);
+            pool.ParallelFor(count, grain, [first, grain, &partial, &start, &fold](size_t begin, size_t end) {
+                R sum = start(first[begin]);
+                for (size_t i = begin + 1; i < end; ++i) {
+                    sum = fold(std::move(sum), first[i]);
+                }
+                partial[begin / grain].Emplace(std::move(sum));
+            });
+            for (Optional<R>& sum : partial) {
+                init = combine(std::move(init), std::move(*sum));
+            }
+            return init;
+        }
+    }  // namespace detail
+
+    template <typename T, typename R, typename Operation>
+    inline R Reduce(T* first, T* last, R init, Operation op, size_t grain, ThreadPool& pool) {
+        auto start = [](const T& x) -> R { return x; };
+        return detail::ReduceChunks(first, last, std::move(init), start, op, op, grain, pool);
+    }
+
+    template <typename T, typename R, typename Fold, typename Combine, typename>
+    inline R Reduce(T* first, T* last, R init, Fold fold, Combine combine, size_t grain, ThreadPool& pool) {
+        auto start = [&fold](const T& x) -> R { return fold(R{}, x); };
+        return detail::ReduceChunks(first, last, std::move(init), start, fold, combine, grain, pool);
+    }
+
+    template <typename T, typename Predicate>
+    inline size_t CountIf(T* first, T* last, Predicate pred, size_t grain, ThreadPool& pool) {
+        std::atomic<size_t> total{ 0 };
+        pool.ParallelFor(last - first, GrainFor<T>(grain), [first, &pred, &total](size_t begin, size_t end) {
+            size_t count = static_cast<size_t>(std::count_if(first + begin, first + end, pred));
+            total.fetch_add(count, std::memory_order_relaxed);
+        });
+        return total.load();
+    }
+
+    template <typename T, typename Value>
+    inline size_t Count(T* first, T* last, const Value& value, size_t grain, ThreadPool& pool) {
+        return CountIf(first, last, [&value](const T& x) { return x == value; }, grain, pool);
+    }
+
+    template <typename T, typename Predicate>
+    inline T* FindIf(T* first, T* last, Predicate pred, size_t grain, ThreadPool& pool) {
+        const size_t count = last - first;
+        std::atomic<size_t> found{ count };
+        pool.ParallelFor(count, GrainFor<T>(grain), [first, &pred, &found](size_t begin, size_t end) {
+            if (begin >= found.load(std::memory_order_relaxed)) {
+                return;
+            }
+            T* match = std::find_if(first + begin, first + end, pred);
+            if (match == first + end) {
+                return;
+            }
+            // keep minimal index, chunks finish in any order
+            size_t index = match - first;
+            size_t current = found.load(std::memory_order_relaxed);
+            while (index < current && !found.compare_exchange_weak(current, index)) {
+            }
+        });
+        return first + found.load();
+    }
+
+    template <typename T, typename Value>
+    inline T* Find(T* first, T* last, const Value& value, size_t grain, ThreadPool& pool) {
+        return FindIf(first, last, [&value](const T& x) { return x == value; }, grain, pool);
+    }
+
+}  // namespace parallel
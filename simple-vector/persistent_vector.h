@@ -0,0 +1,1066 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "vector.h"
+
+// immutable vector: every change returns a new version sharing untouched nodes with the old one
+// 32-way relaxed radix balanced (RRB) tree plus a tail leaf for appends:
+//     Get                     - O(log32 n), radix guess corrected by size tables
+//     Set, PushBack, PopBack  - O(log32 n) nodes copied, PushBack amortized O(1)
+//     Concat, Slice           - O(log32 n) nodes copied or rebalanced, elements of at most
+//                               a few leaves per level copied
+//     auto v2 = v1.PushBack(x).Set(0, y);     // v1 doesn't change
+// Transient changes one version in place for batches: nodes it owns alone are
+// written directly, shared ones are copied once
+//     PersistentVector<int>::Transient batch(v);
+//     for (...) batch.PushBack(i);
+//     v = batch.Persistent();
+// nodes are reference counted atomically, versions may be shared between threads
+template <typename T>
+class PersistentVector {
+public:         // types
+    class Transient;
+    class ConstIterator;
+
+private:        // types
+    static constexpr size_t BITS = 5;
+    static constexpr size_t WIDTH = size_t(1) << BITS;
+    // rebalancing keeps at most EXTRA nodes per level above the optimal count
+    static constexpr size_t EXTRA = 2;
+
+    struct Node {
+        std::atomic<uint32_t> refs{ 1 };
+        uint32_t count = 0;     // elements of leaf, children of inner node
+    };
+
+    struct Leaf : Node {
+        alignas(T) unsigned char storage[WIDTH * sizeof(T)];
+
+        T* Data() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+        const T* Data() const noexcept {
+            return std::launder(reinterpret_cast<const T*>(storage));
+        }
+    };
+
+    // children of inner node at shift hold at most 1 << shift elements each,
+    // so child index is at least index >> shift: size table corrects the guess upwards
+    struct Inner : Node {
+        Node* children[WIDTH];
+        size_t sizes[WIDTH];    // cumulative sizes of children
+    };
+
+private:        // fields
+    Node* root_ = nullptr;      // leaf if shift_ == 0, nullptr if tree is empty
+    Leaf* tail_ = nullptr;      // last elements, outside of tree
+    size_t shift_ = 0;
+    size_t root_size_ = 0;      // elements in tree
+
+public:         // constructors
+    PersistentVector() = default;
+    // copies whole leaves at once
+    template <typename Alloc, typename Growth>
+    explicit PersistentVector(const Vector<T, Alloc, Growth>& v);
+    PersistentVector(const PersistentVector& other) noexcept;
+    PersistentVector(PersistentVector&& other) noexcept;
+    ~PersistentVector();
+
+public:         // iterators
+    using iterator = ConstIterator;
+    using const_iterator = ConstIterator;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+public:         // operators
+    const T& operator[](size_t index) const noexcept;
+
+    PersistentVector& operator=(const PersistentVector& other) noexcept;
+    PersistentVector& operator=(PersistentVector&& other) noexcept;
+
+public:         // methods
+    size_t Size() const noexcept;
+    void Swap(PersistentVector& other) noexcept;
+
+    // new versions
+    PersistentVector Set(size_t index, T value) const;
+    PersistentVector PushBack(T value) const;
+    PersistentVector PopBack() const;
+    // elements of *this followed by elements of other
+    PersistentVector Concat(const PersistentVector& other) const;
+    // elements [first, last)
+    PersistentVector Slice(size_t first, size_t last) const;
+
+    // copies whole leaves at once
+    template <typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+    Vector<T, Alloc, Growth> ToVector() const;
+
+private:        // methods
+    static void Retain(Node* node) noexcept;
+    static void Release(Node* node, size_t shift) noexcept;
+    static bool IsUnique(const Node* node) noexcept;
+    static Leaf* AsLeaf(Node* node) noexcept;
+    static const Leaf* AsLeaf(const Node* node) noexcept;
+    static Inner* AsInner(Node* node) noexcept;
+    static const Inner* AsInner(const Node* node) noexcept;
+    static size_t NodeSize(const Node* node, size_t shift) noexcept;
+    static size_t ChildSize(const Inner* node, size_t child) noexcept;
+    static Leaf* CloneLeaf(const Leaf* leaf);
+    static Inner* CloneInner(const Inner* node);
+    // replaces shared node by its copy
+    static void MakeUnique(Node*& node, size_t shift);
+    // takes child's reference
+    static void AppendChild(Inner* node, Node* child, size_t child_size) noexcept;
+    // chain of inner nodes from shift down to leaf, takes new reference to leaf
+    static Node* NewPath(size_t shift, Node* leaf, size_t size);
+
+    // pointer to element index, remaining - elements from it to the end of its leaf
+    const T* LeafAt(size_t index, size_t& remaining) const noexcept;
+
+    // in-place changes: nodes shared with other versions are copied on the way
+    void MakeTailUnique();
+    void SetInPlace(size_t index, T value);
+    void PushBackInPlace(T value);
+    void PopBackInPlace();
+    void AppendInPlace(const PersistentVector& other);
+    // keeps first count elements
+    void TakeInPlace(size_t count);
+    // drops first count elements
+    void DropInPlace(size_t count);
+
+    // appends leaf to tree, takes new reference to it
+    void PushLeafIntoTree(Leaf* leaf);
+    static bool PushLeaf(Inner* node, size_t shift, Leaf* leaf);
+    // removes last leaf of non-empty tree, gives tree's reference to caller
+    Leaf* PopLastLeaf();
+    static Leaf* PopLeaf(Inner* node, size_t shift);
+    static void TakeTree(Node*& node, size_t shift, size_t count);
+    static void DropTree(Node*& node, size_t shift, size_t count);
+    // removes empty root and roots with single child
+    void ShrinkRoot() noexcept;
+
+    // node at max(left_shift, right_shift) + BITS with one or two children holding
+    // elements of left followed by elements of right
+    static Inner* ConcatTrees(const Node* left, size_t left_shift, const Node* right, size_t right_shift);
+    // redistributes children of left (but last), centre and right (but first), all at shift,
+    // so that few nodes are underfull; consumes centre
+    static Inner* Rebalance(const Inner* left, Inner* centre, const Inner* right, size_t shift);
+};
+
+template <typename T>
+class PersistentVector<T>::ConstIterator {
+public:         // types
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+private:        // fields
+    const PersistentVector* owner_ = nullptr;
+    size_t index_ = 0;
+    const T* current_ = nullptr;
+    size_t remaining_ = 0;      // elements left in current leaf
+
+public:         // constructors
+    ConstIterator() = default;
+    ConstIterator(const PersistentVector* owner, size_t index) noexcept
+        : owner_(owner), index_(index) {
+        if (index_ < owner_->Size()) {
+            current_ = owner_->LeafAt(index_, remaining_);
+        }
+    }
+
+public:         // operators
+    reference operator*() const noexcept {
+        return *current_;
+    }
+    pointer operator->() const noexcept {
+        return current_;
+    }
+    // next element is in the same leaf, except once per leaf
+    ConstIterator& operator++() noexcept {
+        ++index_;
+        if (--remaining_ != 0) {
+            ++current_;
+        }
+        else if (index_ < owner_->Size()) {
+            current_ = owner_->LeafAt(index_, remaining_);
+        }
+        return *this;
+    }
+    ConstIterator operator++(int) noexcept {
+        ConstIterator old = *this;
+        ++*this;
+        return old;
+    }
+    bool operator==(const ConstIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    bool operator!=(const ConstIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+};
+
+// batch of in-place changes to one version
+template <typename T>
+class PersistentVector<T>::Transient {
+private:        // fields
+    PersistentVector vector_;
+
+public:         // constructors
+    Transient() = default;
+    explicit Transient(PersistentVector vector) noexcept
+        : vector_(std::move(vector)) { }
+
+public:         // operators
+    const T& operator[](size_t index) const noexcept {
+        return vector_[index];
+    }
+
+public:         // methods
+    size_t Size() const noexcept {
+        return vector_.Size();
+    }
+    void Set(size_t index, T value) {
+        vector_.SetInPlace(index, std::move(value));
+    }
+    void PushBack(T value) {
+        vector_.PushBackInPlace(std::move(value));
+    }
+    void PopBack() {
+        vector_.PopBackInPlace();
+    }
+    void Append(const PersistentVector& other) {
+        vector_.AppendInPlace(other);
+    }
+    // snapshot shares all nodes, later changes of the batch copy them again
+    PersistentVector Persistent() const& noexcept {
+        return vector_;
+    }
+    PersistentVector Persistent() && noexcept {
+        return std::move(vector_);
+    }
+};
+
+template <typename T>
+template <typename Alloc, typename Growth>
+inline PersistentVector<T>::PersistentVector(const Vector<T, Alloc, Growth>& v) {
+    // built aside: destructor of *this doesn't run if constructor throws
+    PersistentVector built;
+    const T* data = v.begin();
+    for (size_t done = 0; done < v.Size(); done += WIDTH) {
+        const size_t count = std::min(WIDTH, v.Size() - done);
+        Leaf* leaf = new Leaf;
+        try {
+            std::uninitialized_copy_n(data + done, count, leaf->Data());
+        }
+        catch (...) {
+            delete leaf;
+            throw;
+        }
+        leaf->count = static_cast<uint32_t>(count);
+        // previous full leaf goes into tree, the last one stays as tail
+        if (built.tail_ != nullptr) {
+            try {
+                built.PushLeafIntoTree(built.tail_);
+            }
+            catch (...) {
+                Release(leaf, 0);
+                throw;
+            }
+            Release(built.tail_, 0);
+        }
+        built.tail_ = leaf;
+    }
+    Swap(built);
+}
+
+template <typename T>
+inline PersistentVector<T>::PersistentVector(const PersistentVector& other) noexcept
+    : root_(other.root_)
+    , tail_(other.tail_)
+    , shift_(other.shift_)
+    , root_size_(other.root_size_) {
+    Retain(root_);
+    Retain(tail_);
+}
+
+template <typename T>
+inline PersistentVector<T>::PersistentVector(PersistentVector&& other) noexcept
+    : root_(std::exchange(other.root_, nullptr))
+    , tail_(std::exchange(other.tail_, nullptr))
+    , shift_(std::exchange(other.shift_, 0))
+    , root_size_(std::exchange(other.root_size_, 0)) {
+}
+
+template <typename T>
+inline PersistentVector<T>::~PersistentVector() {
+    Release(root_, shift_);
+    Release(tail_, 0);
+}
+
+template <typename T>
+inline typename PersistentVector<T>::const_iterator PersistentVector<T>::begin() const noexcept {
+    return const_iterator(this, 0);
+}
+
+template <typename T>
+inline typename PersistentVector<T>::const_iterator PersistentVector<T>::end() const noexcept {
+    return const_iterator(this, Size());
+}
+
+template <typename T>
+inline typename PersistentVector<T>::const_iterator PersistentVector<T>::cbegin() const noexcept {
+    return begin();
+}
+
+template <typename T>
+inline typename PersistentVector<T>::const_iterator PersistentVector<T>::cend() const noexcept {
+    return end();
+}
+
+template <typename T>
+inline const T& PersistentVector<T>::operator[](size_t index) const noexcept {
+    assert(index < Size());
+    size_t remaining;
+    return *LeafAt(index, remaining);
+}
+
+template <typename T>
+inline PersistentVector<T>& PersistentVector<T>::operator=(const PersistentVector& other) noexcept {
+    if (this != &other) {
+        PersistentVector copy(other);
+        Swap(copy);
+    }
+    return *this;
+}
+
+template <typename T>
+inline PersistentVector<T>& PersistentVector<T>::operator=(PersistentVector&& other) noexcept {
+    if (this != &other) {
+        PersistentVector moved(std::move(other));
+        Swap(moved);
+    }
+    return *this;
+}
+
+template <typename T>
+inline size_t PersistentVector<T>::Size() const noexcept {
+    return root_size_ + (tail_ == nullptr ? 0 : tail_->count);
+}
+
+template <typename T>
+inline void PersistentVector<T>::Swap(PersistentVector& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(tail_, other.tail_);
+    std::swap(shift_, other.shift_);
+    std::swap(root_size_, other.root_size_);
+}
+
+template <typename T>
+inline PersistentVector<T> PersistentVector<T>::Set(size_t index, T value) const {
+    PersistentVector next(*this);
+    next.SetInPlace(index, std::move(value));
+    return next;
+}
+
+template <typename T>
+inline PersistentVector<T> PersistentVector<T>::PushBack(T value) const {
+    PersistentVector next(*this);
+    next.PushBackInPlace(std::move(value));
+    return next;
+}
+
+template <typename T>
+inline PersistentVector<T> PersistentVector<T>::PopBack() const {
+    PersistentVector next(*this);
+    next.PopBackInPlace();
+    return next;
+}
+
+template <typename T>
+inline PersistentVector<T> PersistentVector<T>::Concat(const PersistentVector& other) const {
+    PersistentVector next(*this);
+    next.AppendInPlace(other);
+    return next;
+}
+
+template <typename T>
+inline PersistentVector<T> PersistentVector<T>::Slice(size_t first, size_t last) const {
+    assert(first <= last && last <= Size());
+    PersistentVector next(*this);
+    next.TakeInPlace(last);
+    next.DropInPlace(first);
+    return next;
+}
+
+template <typename T>
+template <typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth> PersistentVector<T>::ToVector() const {
+    Vector<T, Alloc, Growth> v;
+    v.Reserve(Size());
+    for (size_t index = 0; index < Size();) {
+        size_t count;
+        const T* data = LeafAt(index, count);
+        v.Append(data, data + count);
+        index += count;
+    }
+    return v;
+}
+
+template <typename T>
+inline void PersistentVector<T>::Retain(Node* node) noexcept {
+    if (node != nullptr) {
+        node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+inline void PersistentVector<T>::Release(Node* node, size_t shift) noexcept {
+    if (node == nullptr || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    if (shift == 0) {
+        Leaf* leaf = AsLeaf(node);
+        std::destroy_n(leaf->Data(), leaf->count);
+        delete leaf;
+    }
+    else {
+        Inner* inner = AsInner(node);
+        for (size_t i = 0; i < inner->count; ++i) {
+            Release(inner->children[i], shift - BITS);
+        }
+        delete inner;
+    }
+}
+
+template <typename T>
+inline bool PersistentVector<T>::IsUnique(const Node* node) noexcept {
+    // acquire: other versions' reads of node happen before our writes
+    return node->refs.load(std::memory_order_acquire) == 1;
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Leaf* PersistentVector<T>::AsLeaf(Node* node) noexcept {
+    return static_cast<Leaf*>(node);
+}
+
+template <typename T>
+inline const typename PersistentVector<T>::Leaf* PersistentVector<T>::AsLeaf(const Node* node) noexcept {
+    return static_cast<const Leaf*>(node);
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Inner* PersistentVector<T>::AsInner(Node* node) noexcept {
+    return static_cast<Inner*>(node);
+}
+
+template <typename T>
+inline const typename PersistentVector<T>::Inner* PersistentVector<T>::AsInner(const Node* node) noexcept {
+    return static_cast<const Inner*>(node);
+}
+
+template <typename T>
+inline size_t PersistentVector<T>::NodeSize(const Node* node, size_t shift) noexcept {
+    return shift == 0 ? node->count : AsInner(node)->sizes[node->count - 1];
+}
+
+template <typename T>
+inline size_t PersistentVector<T>::ChildSize(const Inner* node, size_t child) noexcept {
+    return node->sizes[child] - (child == 0 ? 0 : node->sizes[child - 1]);
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Leaf* PersistentVector<T>::CloneLeaf(const Leaf* leaf) {
+    Leaf* clone = new Leaf;
+    try {
+        std::uninitialized_copy_n(leaf->Data(), leaf->count, clone->Data());
+    }
+    catch (...) {
+        delete clone;
+        throw;
+    }
+    clone->count = leaf->count;
+    return clone;
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Inner* PersistentVector<T>::CloneInner(const Inner* node) {
+    // children are retained only once allocation succeeded
+    Inner* clone = new Inner;
+    clone->count = node->count;
+    for (size_t i = 0; i < node->count; ++i) {
+        clone->children[i] = node->children[i];
+        clone->sizes[i] = node->sizes[i];
+        Retain(clone->children[i]);
+    }
+    return clone;
+}
+
+template <typename T>
+inline void PersistentVector<T>::MakeUnique(Node*& node, size_t shift) {
+    if (IsUnique(node)) {
+        return;
+    }
+    // node stays as it was if clone throws
+    Node* clone = shift == 0 ? static_cast<Node*>(CloneLeaf(AsLeaf(node))) : CloneInner(AsInner(node));
+    Release(node, shift);
+    node = clone;
+}
+
+template <typename T>
+inline void PersistentVector<T>::AppendChild(Inner* node, Node* child, size_t child_size) noexcept {
+    assert(node->count < WIDTH);
+    node->children[node->count] = child;
+    node->sizes[node->count] = (node->count == 0 ? 0 : node->sizes[node->count - 1]) + child_size;
+    ++node->count;
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Node* PersistentVector<T>::NewPath(size_t shift, Node* leaf, size_t size) {
+    Retain(leaf);
+    Node* node = leaf;
+    size_t level = 0;
+    try {
+        for (; level < shift; level += BITS) {
+            Inner* parent = new Inner;
+            AppendChild(parent, node, size);
+            node = parent;
+        }
+    }
+    catch (...) {
+        Release(node, level);
+        throw;
+    }
+    return node;
+}
+
+template <typename T>
+inline const T* PersistentVector<T>::LeafAt(size_t index, size_t& remaining) const noexcept {
+    if (index >= root_size_) {
+        index -= root_size_;
+        remaining = tail_->count - index;
+        return tail_->Data() + index;
+    }
+    const Node* node = root_;
+    for (size_t shift = shift_; shift > 0; shift -= BITS) {
+        const Inner* inner = AsInner(node);
+        size_t child = index >> shift;
+        while (inner->sizes[child] <= index) {
+            ++child;
+        }
+        if (child != 0) {
+            index -= inner->sizes[child - 1];
+        }
+        node = inner->children[child];
+    }
+    remaining = node->count - index;
+    return AsLeaf(node)->Data() + index;
+}
+
+template <typename T>
+inline void PersistentVector<T>::MakeTailUnique() {
+    if (!IsUnique(tail_)) {
+        Leaf* clone = CloneLeaf(tail_);
+        Release(tail_, 0);
+        tail_ = clone;
+    }
+}
+
+template <typename T>
+inline void PersistentVector<T>::SetInPlace(size_t index, T value) {
+    assert(index < Size());
+    if (index >= root_size_) {
+        MakeTailUnique();
+        tail_->Data()[index - root_size_] = std::move(value);
+        return;
+    }
+    Node** node = &root_;
+    for (size_t shift = shift_; shift > 0; shift -= BITS) {
+        MakeUnique(*node, shift);
+        Inner* inner = AsInner(*node);
+        size_t child = index >> shift;
+        while (inner->sizes[child] <= index) {
+            ++child;
+        }
+        if (child != 0) {
+            index -= inner->sizes[child - 1];
+        }
+        node = &inner->children[child];
+    }
+    MakeUnique(*node, 0);
+    AsLeaf(*node)->Data()[index] = std::move(value);
+}
+
+template <typename T>
+inline void PersistentVector<T>::PushBackInPlace(T value) {
+    if (tail_ != nullptr && tail_->count == WIDTH) {
+        PushLeafIntoTree(tail_);
+        Release(tail_, 0);
+        tail_ = nullptr;
+    }
+    if (tail_ == nullptr) {
+        tail_ = new Leaf;
+    }
+    else {
+        MakeTailUnique();
+    }
+    new (tail_->Data() + tail_->count) T(std::move(value));
+    ++tail_->count;
+}
+
+template <typename T>
+inline void PersistentVector<T>::PopBackInPlace() {
+    assert(Size() != 0);
+    if (tail_ == nullptr || tail_->count == 0) {
+        Leaf* leaf = PopLastLeaf();
+        Release(tail_, 0);
+        tail_ = leaf;
+    }
+    MakeTailUnique();
+    --tail_->count;
+    std::destroy_at(tail_->Data() + tail_->count);
+}
+
+template <typename T>
+inline void PersistentVector<T>::AppendInPlace(const PersistentVector& other) {
+    if (other.Size() == 0) {
+        return;
+    }
+    if (Size() == 0) {
+        *this = other;
+        return;
+    }
+    if (other.root_ == nullptr) {
+        // at most one leaf
+        for (size_t i = 0; i < other.tail_->count; ++i) {
+            PushBackInPlace(other.tail_->Data()[i]);
+        }
+        return;
+    }
+
+    // own tail goes into tree, so the trees can be joined
+    if (tail_ != nullptr) {
+        if (tail_->count != 0) {
+            PushLeafIntoTree(tail_);
+        }
+        Release(tail_, 0);
+        tail_ = nullptr;
+    }
+    Inner* joined = ConcatTrees(root_, shift_, other.root_, other.shift_);
+    Release(root_, shift_);
+    root_ = joined;
+    shift_ = std::max(shift_, other.shift_) + BITS;
+    root_size_ += other.root_size_;
+    ShrinkRoot();
+    tail_ = other.tail_;
+    Retain(tail_);
+}
+
+template <typename T>
+inline void PersistentVector<T>::TakeInPlace(size_t count) {
+    assert(count <= Size());
+    if (count >= root_size_) {
+        const size_t keep = count - root_size_;
+        if (tail_ != nullptr && keep < tail_->count) {
+            MakeTailUnique();
+            std::destroy_n(tail_->Data() + keep, tail_->count - keep);
+            tail_->count = static_cast<uint32_t>(keep);
+        }
+        return;
+    }
+    Release(tail_, 0);
+    tail_ = nullptr;
+    if (count == 0) {
+        Release(root_, shift_);
+        root_ = nullptr;
+        shift_ = 0;
+        root_size_ = 0;
+        return;
+    }
+    TakeTree(root_, shift_, count);
+    root_size_ = count;
+    ShrinkRoot();
+    // last leaf becomes tail, so appends continue in it
+    tail_ = PopLastLeaf();
+}
+
+template <typename T>
+inline void PersistentVector<T>::DropInPlace(size_t count) {
+    assert(count <= Size());
+    if (count == 0) {
+        return;
+    }
+    if (count >= root_size_) {
+        const size_t drop = count - root_size_;
+        Release(root_, shift_);
+        root_ = nullptr;
+        shift_ = 0;
+        root_size_ = 0;
+        if (drop != 0) {
+            MakeTailUnique();
+            T* data = tail_->Data();
+            std::move(data + drop, data + tail_->count, data);
+            std::destroy_n(data + tail_->count - drop, drop);
+            tail_->count -= static_cast<uint32_t>(drop);
+        }
+        return;
+    }
+    DropTree(root_, shift_, count);
+    root_size_ -= count;
+    ShrinkRoot();
+}
+
+template <typename T>
+inline void PersistentVector<T>::PushLeafIntoTree(Leaf* leaf) {
+    const size_t size = leaf->count;
+    if (root_ == nullptr) {
+        Retain(leaf);
+        root_ = leaf;
+        shift_ = 0;
+        root_size_ = size;
+        return;
+    }
+    if (shift_ != 0) {
+        MakeUnique(root_, shift_);
+        if (PushLeaf(AsInner(root_), shift_, leaf)) {
+            root_size_ += size;
+            return;
+        }
+    }
+    // tree is full: new root above it
+    Inner* root = new Inner;
+    Node* path;
+    try {
+        path = NewPath(shift_, leaf, size);
+    }
+    catch (...) {
+        delete root;
+        throw;
+    }
+    AppendChild(root, root_, root_size_);
+    AppendChild(root, path, size);
+    root_ = root;
+    shift_ += BITS;
+    root_size_ += size;
+}
+
+template <typename T>
+inline bool PersistentVector<T>::PushLeaf(Inner* node, size_t shift, Leaf* leaf) {
+    const size_t size = leaf->count;
+    if (shift == BITS) {
+        if (node->count == WIDTH) {
+            return false;
+        }
+        Retain(leaf);
+        AppendChild(node, leaf, size);
+        return true;
+    }
+    Node*& last = node->children[node->count - 1];
+    MakeUnique(last, shift - BITS);
+    if (PushLeaf(AsInner(last), shift - BITS, leaf)) {
+        node->sizes[node->count - 1] += size;
+        return true;
+    }
+    if (node->count == WIDTH) {
+        return false;
+    }
+    AppendChild(node, NewPath(shift - BITS, leaf, size), size);
+    return true;
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Leaf* PersistentVector<T>::PopLastLeaf() {
+    assert(root_ != nullptr);
+    if (shift_ == 0) {
+        Leaf* leaf = AsLeaf(root_);
+        root_ = nullptr;
+        root_size_ = 0;
+        return leaf;
+    }
+    MakeUnique(root_, shift_);
+    Leaf* leaf = PopLeaf(AsInner(root_), shift_);
+    root_size_ -= leaf->count;
+    ShrinkRoot();
+    return leaf;
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Leaf* PersistentVector<T>::PopLeaf(Inner* node, size_t shift) {
+    Node*& last = node->children[node->count - 1];
+    if (shift == BITS) {
+        --node->count;
+        return AsLeaf(last);
+    }
+    MakeUnique(last, shift - BITS);
+    Leaf* leaf = PopLeaf(AsInner(last), shift - BITS);
+    if (last->count == 0) {
+        Release(last, shift - BITS);
+        --node->count;
+    }
+    else {
+        node->sizes[node->count - 1] -= leaf->count;
+    }
+    return leaf;
+}
+
+template <typename T>
+inline void PersistentVector<T>::TakeTree(Node*& node, size_t shift, size_t count) {
+    MakeUnique(node, shift);
+    if (shift == 0) {
+        Leaf* leaf = AsLeaf(node);
+        std::destroy_n(leaf->Data() + count, leaf->count - count);
+        leaf->count = static_cast<uint32_t>(count);
+        return;
+    }
+    // child holding element count - 1
+    Inner* inner = AsInner(node);
+    size_t child = (count - 1) >> shift;
+    while (inner->sizes[child] < count) {
+        ++child;
+    }
+    const size_t before = child == 0 ? 0 : inner->sizes[child - 1];
+    TakeTree(inner->children[child], shift - BITS, count - before);
+    for (size_t i = child + 1; i < inner->count; ++i) {
+        Release(inner->children[i], shift - BITS);
+    }
+    inner->count = static_cast<uint32_t>(child + 1);
+    inner->sizes[child] = count;
+}
+
+template <typename T>
+inline void PersistentVector<T>::DropTree(Node*& node, size_t shift, size_t count) {
+    MakeUnique(node, shift);
+    if (shift == 0) {
+        Leaf* leaf = AsLeaf(node);
+        T* data = leaf->Data();
+        std::move(data + count, data + leaf->count, data);
+        std::destroy_n(data + leaf->count - count, count);
+        leaf->count -= static_cast<uint32_t>(count);
+        return;
+    }
+    // child holding element count
+    Inner* inner = AsInner(node);
+    size_t child = count >> shift;
+    while (inner->sizes[child] <= count) {
+        ++child;
+    }
+    const size_t before = child == 0 ? 0 : inner->sizes[child - 1];
+    if (count != before) {
+        DropTree(inner->children[child], shift - BITS, count - before);
+    }
+    for (size_t i = 0; i < child; ++i) {
+        Release(inner->children[i], shift - BITS);
+    }
+    for (size_t i = child; i < inner->count; ++i) {
+        inner->children[i - child] = inner->children[i];
+        inner->sizes[i - child] = inner->sizes[i] - count;
+    }
+    inner->count -= static_cast<uint32_t>(child);
+}
+
+template <typename T>
+inline void PersistentVector<T>::ShrinkRoot() noexcept {
+    while (root_ != nullptr && shift_ != 0) {
+        Inner* root = AsInner(root_);
+        if (root->count == 0) {
+            Release(root_, shift_);
+            root_ = nullptr;
+        }
+        else if (root->count == 1) {
+            Node* child = root->children[0];
+            Retain(child);
+            Release(root_, shift_);
+            root_ = child;
+            shift_ -= BITS;
+        }
+        else {
+            return;
+        }
+    }
+    if (root_ == nullptr) {
+        shift_ = 0;
+    }
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Inner* PersistentVector<T>::ConcatTrees(
+    const Node* left, size_t left_shift, const Node* right, size_t right_shift)
+{
+    if (left_shift > right_shift) {
+        const Inner* l = AsInner(left);
+        Inner* centre = ConcatTrees(l->children[l->count - 1], left_shift - BITS, right, right_shift);
+        return Rebalance(l, centre, nullptr, left_shift);
+    }
+    if (left_shift < right_shift) {
+        const Inner* r = AsInner(right);
+        Inner* centre = ConcatTrees(left, left_shift, r->children[0], right_shift - BITS);
+        return Rebalance(nullptr, centre, r, right_shift);
+    }
+    if (left_shift == 0) {
+        // two leaves: one merged leaf if it fits, parent rebalances otherwise
+        const Leaf* l = AsLeaf(left);
+        const Leaf* r = AsLeaf(right);
+        Inner* node = new Inner;
+        if (l->count + r->count > WIDTH) {
+            Retain(const_cast<Node*>(left));
+            Retain(const_cast<Node*>(right));
+            AppendChild(node, const_cast<Node*>(left), l->count);
+            AppendChild(node, const_cast<Node*>(right), r->count);
+            return node;
+        }
+        Leaf* merged = nullptr;
+        try {
+            merged = CloneLeaf(l);
+            std::uninitialized_copy_n(r->Data(), r->count, merged->Data() + merged->count);
+        }
+        catch (...) {
+            Release(merged, 0);
+            delete node;
+            throw;
+        }
+        merged->count += r->count;
+        AppendChild(node, merged, merged->count);
+        return node;
+    }
+    const Inner* l = AsInner(left);
+    const Inner* r = AsInner(right);
+    Inner* centre = ConcatTrees(l->children[l->count - 1], left_shift - BITS, r->children[0], right_shift - BITS);
+    return Rebalance(l, centre, r, left_shift);
+}
+
+template <typename T>
+inline typename PersistentVector<T>::Inner* PersistentVector<T>::Rebalance(
+    const Inner* left, Inner* centre, const Inner* right, size_t shift)
+{
+    const size_t child_shift = shift - BITS;
+
+    // children at child_shift, in order
+    Node* all[2 * WIDTH + 1];
+    size_t count = 0;
+    if (left != nullptr) {
+        for (size_t i = 0; i + 1 < left->count; ++i) {
+            all[count++] = left->children[i];
+        }
+    }
+    for (size_t i = 0; i < centre->count; ++i) {
+        all[count++] = centre->children[i];
+    }
+    if (right != nullptr) {
+        for (size_t i = 1; i < right->count; ++i) {
+            all[count++] = right->children[i];
+        }
+    }
+
+    // plan: slots of new nodes; underfull nodes are spread over the following ones
+    // until at most EXTRA nodes more than optimal remain
+    size_t plan[2 * WIDTH + 2];
+    size_t slots = 0;
+    for (size_t i = 0; i < count; ++i) {
+        plan[i] = all[i]->count;
+        slots += plan[i];
+    }
+    plan[count] = 0;
+    const size_t optimal = (slots + WIDTH - 1) / WIDTH;
+    size_t length = count;
+    for (size_t i = 0; length > optimal + EXTRA;) {
+        while (plan[i] >= WIDTH - EXTRA / 2) {
+            ++i;
+        }
+        size_t remaining = plan[i];
+        do {
+            const size_t fill = std::min(remaining + plan[i + 1], WIDTH);
+            remaining = remaining + plan[i + 1] - fill;
+            plan[i] = fill;
+            ++i;
+        } while (remaining != 0);
+        for (size_t j = i; j < length; ++j) {
+            plan[j] = plan[j + 1];
+        }
+        --length;
+        --i;
+    }
+
+    // new nodes take slots in order, nodes the plan keeps as they are are shared
+    Node* built[2 * WIDTH + 1];
+    size_t built_count = 0;
+    size_t adopted = 0;     // built nodes owned by parents in result
+    Inner* result = nullptr;
+    try {
+        size_t source = 0;
+        size_t offset = 0;
+        for (size_t k = 0; k < length; ++k) {
+            if (offset == 0 && all[source]->count == plan[k]) {
+                Retain(all[source]);
+                built[built_count++] = all[source++];
+                continue;
+            }
+            if (child_shift == 0) {
+                Leaf* leaf = new Leaf;
+                built[built_count++] = leaf;
+                while (leaf->count < plan[k]) {
+                    const Leaf* from = AsLeaf(all[source]);
+                    const size_t take = std::min<size_t>(plan[k] - leaf->count, from->count - offset);
+                    std::uninitialized_copy_n(from->Data() + offset, take, leaf->Data() + leaf->count);
+                    leaf->count += static_cast<uint32_t>(take);
+                    offset += take;
+                    if (offset == from->count) {
+                        ++source;
+                        offset = 0;
+                    }
+                }
+            }
+            else {
+                Inner* node = new Inner;
+                built[built_count++] = node;
+                while (node->count < plan[k]) {
+                    const Inner* from = AsInner(all[source]);
+                    Retain(from->children[offset]);
+                    AppendChild(node, from->children[offset], ChildSize(from, offset));
+                    ++offset;
+                    if (offset == from->count) {
+                        ++source;
+                        offset = 0;
+                    }
+                }
+            }
+        }
+
+        // up to 2 * WIDTH nodes: one or two parents
+        result = new Inner;
+        for (size_t first = 0; first < built_count; first += WIDTH) {
+            Inner* parent = new Inner;
+            AppendChild(result, parent, 0);
+            for (size_t k = first; k < std::min(built_count, first + WIDTH); ++k) {
+                AppendChild(parent, built[k], NodeSize(built[k], child_shift));
+                ++adopted;
+            }
+            result->sizes[result->count - 1] += NodeSize(parent, shift);
+        }
+    }
+    catch (...) {
+        if (result != nullptr) {
+            Release(result, shift + BITS);
+        }
+        for (size_t k = adopted; k < built_count; ++k) {
+            Release(built[k], child_shift);
+        }
+        Release(centre, shift);
+        throw;
+    }
+    Release(centre, shift);
+    return result;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "vector.h"
+
+// allocator growing blocks without copying where the system allows it
+// (Linux only, needs mremap):
+//     below MmapThreshold bytes - malloc / realloc
+//     from MmapThreshold bytes  - own anonymous mapping grown by mremap(MREMAP_MAYMOVE),
+//                                 kernel moves page table entries instead of bytes
+// Vector uses reallocate() only for trivially relocatable elements
+template <typename T, size_t MmapThreshold = (size_t(1) << 20)>
+class RemapAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+        "RemapAllocator gives only malloc alignment");
+
+public:         // types
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = RemapAllocator<U, MmapThreshold>;
+    };
+
+public:         // constructors
+    RemapAllocator() = default;
+    template <typename U>
+    RemapAllocator(const RemapAllocator<U, MmapThreshold>&) noexcept { }
+
+public:         // methods
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n) noexcept;
+    // grows (or shrinks) block, bytes are kept but may move
+    T* reallocate(T* p, size_t old_n, size_t new_n);
+
+private:        // methods
+    static bool IsMapped(size_t bytes) noexcept;
+    static size_t MappedLength(size_t bytes) noexcept;
+};
+
+template <typename T, typename U, size_t MmapThreshold>
+bool operator==(const RemapAllocator<T, MmapThreshold>&, const RemapAllocator<U, MmapThreshold>&) noexcept;
+template <typename T, typename U, size_t MmapThreshold>
+bool operator!=(const RemapAllocator<T, MmapThreshold>&, const RemapAllocator<U, MmapThreshold>&) noexcept;
+
+// vector for huge trivially copyable buffers
+template <typename T>
+using RemapVector = Vector<T, RemapAllocator<T>>;
+
+template <typename T, size_t MmapThreshold>
+inline T* RemapAllocator<T, MmapThreshold>::allocate(size_t n) {
+    const size_t bytes = n * sizeof(T);
+    void* p = nullptr;
+    if (IsMapped(bytes)) {
+        p = mmap(nullptr, MappedLength(bytes), PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+    }
+    else {
+        p = std::malloc(bytes);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    return static_cast<T*>(p);
+}
+
+template <typename T, size_t MmapThreshold>
+inline void RemapAllocator<T, MmapThreshold>::deallocate(T* p, size_t n) noexcept {
+    const size_t bytes = n * sizeof(T);
+    if (IsMapped(bytes)) {
+        munmap(p, MappedLength(bytes));
+    }
+    else {
+        std::free(p);
+    }
+}
+
+template <typename T, size_t MmapThreshold>
+inline T* RemapAllocator<T, MmapThreshold>::reallocate(T* p, size_t old_n, size_t new_n) {
+    const size_t old_bytes = old_n * sizeof(T);
+    const size_t new_bytes = new_n * sizeof(T);
+
+    if (IsMapped(old_bytes) && IsMapped(new_bytes)) {
+        void* moved = mremap(p, MappedLength(old_bytes), MappedLength(new_bytes), MREMAP_MAYMOVE);
+        if (moved == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(moved);
+    }
+    if (!IsMapped(old_bytes) && !IsMapped(new_bytes)) {
+        void* moved = std::realloc(static_cast<void*>(p), new_bytes);
+        if (moved == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(moved);
+    }
+    // crossing threshold - one copy into the other kind of block
+    T* moved = allocate(new_n);
+    std::memcpy(static_cast<void*>(moved), static_cast<const void*>(p), std::min(old_bytes, new_bytes));
+    deallocate(p, old_n);
+    return moved;
+}
+
+template <typename T, size_t MmapThreshold>
+inline bool RemapAllocator<T, MmapThreshold>::IsMapped(size_t bytes) noexcept {
+    return bytes >= MmapThreshold;
+}
+
+template <typename T, size_t MmapThreshold>
+inline size_t RemapAllocator<T, MmapThreshold>::MappedLength(size_t bytes) noexcept {
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return (bytes + page_size - 1) & ~(page_size - 1);
+}
+
+template <typename T, typename U, size_t MmapThreshold>
+inline bool operator==(const RemapAllocator<T, MmapThreshold>&, const RemapAllocator<U, MmapThreshold>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U, size_t MmapThreshold>
+inline bool operator!=(const RemapAllocator<T, MmapThreshold>&, const RemapAllocator<U, MmapThreshold>&) noexcept {
+    return false;
+}
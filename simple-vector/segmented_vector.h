@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+// default chunk - about 4 KiB, at least one element
+template <typename T>
+inline constexpr size_t DEFAULT_CHUNK_SIZE = sizeof(T) < 4096 ? 4096 / sizeof(T) : 1;
+
+// vector of fixed-size chunks: growth adds one chunk to the directory and never
+// moves elements, so pointers and references stay valid until the element is erased
+// (no 2x memory peak on growth either); only the directory of chunk buffers grows
+template <typename T, size_t ChunkSize = DEFAULT_CHUNK_SIZE<T>>
+class SegmentedVector {
+    static_assert(ChunkSize > 0, "SegmentedVector needs at least one element per chunk");
+
+private:        // types
+    template <bool IsConst>
+    class Iterator;
+
+private:        // fields
+    Vector<RawMemory<T>> chunks_;
+    size_t size_ = 0;
+
+public:         // constructors
+    SegmentedVector() = default;
+    explicit SegmentedVector(size_t size);
+    SegmentedVector(const SegmentedVector& other);
+    SegmentedVector(SegmentedVector&& other) noexcept;
+    ~SegmentedVector();
+
+public:         // iterators
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+public:         // operators
+    const T& operator[](size_t index) const noexcept;
+    T& operator[](size_t index) noexcept;
+
+    SegmentedVector& operator=(const SegmentedVector& other);
+    SegmentedVector& operator=(SegmentedVector&& other) noexcept;
+
+public:         // methods
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+    size_t ChunkCount() const noexcept;
+    // allocates chunks up to new_capacity, elements don't move
+    void Reserve(size_t new_capacity);
+    void Swap(SegmentedVector& other) noexcept;
+    void Resize(size_t new_size);
+    void PopBack() /* noexcept */;
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+    void Clear() noexcept;
+    // frees chunks past the last element
+    void ShrinkToFit() noexcept;
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+private:        // methods
+    T* Slot(size_t index) noexcept;
+    const T* Slot(size_t index) const noexcept;
+    // chunk for element with index size_
+    void AddChunkIfFull();
+};
+
+template <typename T, size_t ChunkSize>
+template <bool IsConst>
+class SegmentedVector<T, ChunkSize>::Iterator {
+public:         // types
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+    using Owner = std::conditional_t<IsConst, const SegmentedVector, SegmentedVector>;
+
+private:        // fields
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+
+public:         // constructors
+    Iterator() = default;
+    Iterator(Owner* owner, size_t index) noexcept
+        : owner_(owner), index_(index) { }
+    // iterator -> const_iterator
+    template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    Iterator(const Iterator<OtherConst>& other) noexcept
+        : owner_(other.owner_), index_(other.index_) { }
+
+public:         // operators
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+    pointer operator->() const noexcept {
+        return &(*owner_)[index_];
+    }
+    reference operator[](difference_type offset) const noexcept {
+        return (*owner_)[index_ + offset];
+    }
+    Iterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    Iterator operator++(int) noexcept {
+        Iterator old = *this;
+        ++index_;
+        return old;
+    }
+    Iterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    Iterator operator--(int) noexcept {
+        Iterator old = *this;
+        --index_;
+        return old;
+    }
+    Iterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+    Iterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+    Iterator operator+(difference_type offset) const noexcept {
+        return Iterator(owner_, index_ + offset);
+    }
+    friend Iterator operator+(difference_type offset, const Iterator& it) noexcept {
+        return it + offset;
+    }
+    Iterator operator-(difference_type offset) const noexcept {
+        return Iterator(owner_, index_ - offset);
+    }
+    difference_type operator-(const Iterator& other) const noexcept {
+        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+    }
+    bool operator==(const Iterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    bool operator!=(const Iterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+    bool operator<(const Iterator& other) const noexcept {
+        return index_ < other.index_;
+    }
+    bool operator>(const Iterator& other) const noexcept {
+        return index_ > other.index_;
+    }
+    bool operator<=(const Iterator& other) const noexcept {
+        return index_ <= other.index_;
+    }
+    bool operator>=(const Iterator& other) const noexcept {
+        return index_ >= other.index_;
+    }
+
+private:
+    template <bool>
+    friend class Iterator;
+};
+
+template <typename T, size_t ChunkSize>
+inline SegmentedVector<T, ChunkSize>::SegmentedVector(size_t size) {
+    // destructor doesn't run if constructor throws
+    try {
+        Resize(size);
+    }
+    catch (...) {
+        Clear();
+        throw;
+    }
+}
+
+template <typename T, size_t ChunkSize>
+inline SegmentedVector<T, ChunkSize>::SegmentedVector(const SegmentedVector& other) {
+    try {
+        Reserve(other.size_);
+        for (size_t i = 0; i < other.size_; ++i) {
+            new (Slot(i)) T(other[i]);
+            ++size_;
+        }
+    }
+    catch (...) {
+        Clear();
+        throw;
+    }
+}
+
+template <typename T, size_t ChunkSize>
+inline SegmentedVector<T, ChunkSize>::SegmentedVector(SegmentedVector&& other) noexcept
+    : chunks_(std::move(other.chunks_))
+    , size_(std::exchange(other.size_, 0)) {
+}
+
+template <typename T, size_t ChunkSize>
+inline SegmentedVector<T, ChunkSize>::~SegmentedVector() {
+    Clear();
+}
+
+template <typename T, size_t ChunkSize>
+inline typename SegmentedVector<T, ChunkSize>::iterator SegmentedVector<T, ChunkSize>::begin() noexcept {
+    return iterator(this, 0);
+}
+
+template <typename T, size_t ChunkSize>
+inline typename SegmentedVector<T, ChunkSize>::iterator SegmentedVector<T, ChunkSize>::end() noexcept {
+    return iterator(this, size_);
+}
+
+template <typename T, size_t ChunkSize>
+inline typename SegmentedVector<T, ChunkSize>::const_iterator SegmentedVector<T, ChunkSize>::begin() const noexcept {
+    return const_iterator(this, 0);
+}
+
+template <typename T, size_t ChunkSize>
+inline typename SegmentedVector<T, ChunkSize>::const_iterator SegmentedVector<T, ChunkSize>::end() const noexcept {
+    return const_iterator(this, size_);
+}
+
+template <typename T, size_t ChunkSize>
+inline typename SegmentedVector<T, ChunkSize>::const_iterator SegmentedVector<T, ChunkSize>::cbegin() const noexcept {
+    return begin();
+}
+
+template <typename T, size_t ChunkSize>
+inline typename SegmentedVector<T, ChunkSize>::const_iterator SegmentedVector<T, ChunkSize>::cend() const noexcept {
+    return end();
+}
+
+template <typename T, size_t ChunkSize>
+inline const T& SegmentedVector<T, ChunkSize>::operator[](size_t index) const noexcept {
+    assert(index < size_);
+    return *Slot(index);
+}
+
+template <typename T, size_t ChunkSize>
+inline T& SegmentedVector<T, ChunkSize>::operator[](size_t index) noexcept {
+    assert(index < size_);
+    return *Slot(index);
+}
+
+template <typename T, size_t ChunkSize>
+inline SegmentedVector<T, ChunkSize>& SegmentedVector<T, ChunkSize>::operator=(const SegmentedVector& other) {
+    if (this != &other) {
+        SegmentedVector copy(other);
+        Swap(copy);
+    }
+    return *this;
+}
+
+template <typename T, size_t ChunkSize>
+inline SegmentedVector<T, ChunkSize>& SegmentedVector<T, ChunkSize>::operator=(SegmentedVector&& other) noexcept {
+    if (this != &other) {
+        Clear();
+        chunks_ = std::move(other.chunks_);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+template <typename T, size_t ChunkSize>
+inline size_t SegmentedVector<T, ChunkSize>::Size() const noexcept {
+    return size_;
+}
+
+template <typename T, size_t ChunkSize>
+inline size_t SegmentedVector<T, ChunkSize>::Capacity() const noexcept {
+    return chunks_.Size() * ChunkSize;
+}
+
+template <typename T, size_t ChunkSize>
+inline size_t SegmentedVector<T, ChunkSize>::ChunkCount() const noexcept {
+    return chunks_.Size();
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::Reserve(size_t new_capacity) {
+    const size_t chunk_count = (new_capacity + ChunkSize - 1) / ChunkSize;
+    if (chunk_count <= chunks_.Size()) {
+        return;
+    }
+    chunks_.Reserve(chunk_count);
+    while (chunks_.Size() < chunk_count) {
+        chunks_.EmplaceBack(ChunkSize);
+    }
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::Swap(SegmentedVector& other) noexcept {
+    chunks_.Swap(other.chunks_);
+    std::swap(size_, other.size_);
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::Resize(size_t new_size) {
+    if (new_size > size_) {
+        Reserve(new_size);
+        for (; size_ < new_size; ++size_) {
+            new (Slot(size_)) T();
+        }
+    }
+    else {
+        while (size_ > new_size) {
+            PopBack();
+        }
+    }
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::PopBack() {
+    if (size_ == 0) {
+        return;
+    }
+    --size_;
+    std::destroy_at(Slot(size_));
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::PushBack(const T& value) {
+    EmplaceBack(value);
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::Clear() noexcept {
+    // chunk by chunk - no division per element
+    size_t remaining = size_;
+    for (size_t chunk = 0; remaining != 0; ++chunk) {
+        const size_t count = std::min(remaining, ChunkSize);
+        std::destroy_n(chunks_[chunk].GetAddress(), count);
+        remaining -= count;
+    }
+    size_ = 0;
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::ShrinkToFit() noexcept {
+    const size_t used = (size_ + ChunkSize - 1) / ChunkSize;
+    while (chunks_.Size() > used) {
+        chunks_.PopBack();
+    }
+}
+
+template <typename T, size_t ChunkSize>
+template <typename... Args>
+inline T& SegmentedVector<T, ChunkSize>::EmplaceBack(Args&&... args) {
+    // args may refer to an element: it doesn't move, no copy needed
+    AddChunkIfFull();
+    T* slot = new (Slot(size_)) T(std::forward<Args>(args)...);
+    ++size_;
+    return *slot;
+}
+
+template <typename T, size_t ChunkSize>
+inline T* SegmentedVector<T, ChunkSize>::Slot(size_t index) noexcept {
+    return chunks_[index / ChunkSize].GetAddress() + index % ChunkSize;
+}
+
+template <typename T, size_t ChunkSize>
+inline const T* SegmentedVector<T, ChunkSize>::Slot(size_t index) const noexcept {
+    return chunks_[index / ChunkSize].GetAddress() + index % ChunkSize;
+}
+
+template <typename T, size_t ChunkSize>
+inline void SegmentedVector<T, ChunkSize>::AddChunkIfFull() {
+    if (size_ == Capacity()) {
+        chunks_.EmplaceBack(ChunkSize);
+    }
+}
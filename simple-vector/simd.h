@@ -0,0 +1,731 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+// vectorized scans over arithmetic buffers (int32_t, int64_t, float, double):
+// SSE2 / AVX2 / AVX-512 kernels are picked once at runtime by CPUID, scalar code elsewhere;
+// Vector overloads work right on Vector's buffer
+//     if (simd::Contains(ids, id)) ...
+//     auto [low, high] = simd::MinMax(prices);
+// integer Sum / Dot wrap around like unsigned arithmetic,
+// float Sum / Dot add lane-wise (rounding differs from a serial loop),
+// MinMax result is unspecified if floats contain NaN
+namespace simd {
+
+    enum class Isa {
+        SCALAR,
+        SSE2,
+        AVX2,
+        AVX512,     // F + DQ
+    };
+
+    // best instruction set of this CPU
+    Isa DetectIsa() noexcept;
+    // instruction set used by kernels, DetectIsa() by default
+    Isa GetIsa() noexcept;
+    // limits kernels to isa (never above DetectIsa()), for tests and benchmarks
+    void SetIsa(Isa isa) noexcept;
+
+    template <typename T>
+    inline constexpr bool is_simd_type_v =
+        std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t> ||
+        std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    template <typename T>
+    const T* Find(const T* first, const T* last, T value);
+    template <typename T>
+    size_t Count(const T* first, const T* last, T value);
+    template <typename T>
+    bool Contains(const T* first, const T* last, T value);
+    // range must not be empty
+    template <typename T>
+    std::pair<T, T> MinMax(const T* first, const T* last);
+    template <typename T>
+    T Sum(const T* first, const T* last);
+    template <typename T>
+    T Dot(const T* first, const T* last, const T* other);
+
+    namespace detail {
+
+        template <typename T>
+        struct Identity {
+            using type = T;
+        };
+
+    }  // namespace detail
+
+    template <typename T, typename Alloc, typename Growth>
+    const T* Find(const Vector<T, Alloc, Growth>& v, typename detail::Identity<T>::type value);
+    template <typename T, typename Alloc, typename Growth>
+    size_t Count(const Vector<T, Alloc, Growth>& v, typename detail::Identity<T>::type value);
+    template <typename T, typename Alloc, typename Growth>
+    bool Contains(const Vector<T, Alloc, Growth>& v, typename detail::Identity<T>::type value);
+    template <typename T, typename Alloc, typename Growth>
+    std::pair<T, T> MinMax(const Vector<T, Alloc, Growth>& v);
+    template <typename T, typename Alloc, typename Growth>
+    T Sum(const Vector<T, Alloc, Growth>& v);
+    // vectors must have equal sizes
+    template <typename T, typename Alloc, typename Growth, typename OtherAlloc, typename OtherGrowth>
+    T Dot(const Vector<T, Alloc, Growth>& v, const Vector<T, OtherAlloc, OtherGrowth>& other);
+
+    namespace detail {
+
+        // integers wrap instead of signed overflow
+        template <typename T>
+        inline T WrapAdd(T a, T b) noexcept {
+            if constexpr (std::is_integral_v<T>) {
+                using U = std::make_unsigned_t<T>;
+                return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+            }
+            else {
+                return a + b;
+            }
+        }
+
+        template <typename T>
+        inline T WrapMul(T a, T b) noexcept {
+            if constexpr (std::is_integral_v<T>) {
+                using U = std::make_unsigned_t<T>;
+                return static_cast<T>(static_cast<U>(a) * static_cast<U>(b));
+            }
+            else {
+                return a * b;
+            }
+        }
+
+        template <typename T>
+        inline const T* ScalarFind(const T* p, size_t n, T value) noexcept {
+            return std::find(p, p + n, value);
+        }
+
+        template <typename T>
+        inline size_t ScalarCount(const T* p, size_t n, T value) noexcept {
+            return static_cast<size_t>(std::count(p, p + n, value));
+        }
+
+        template <typename T>
+        inline std::pair<T, T> ScalarMinMax(const T* p, size_t n, std::pair<T, T> init) noexcept {
+            for (size_t i = 0; i < n; ++i) {
+                init.first = p[i] < init.first ? p[i] : init.first;
+                init.second = init.second < p[i] ? p[i] : init.second;
+            }
+            return init;
+        }
+
+        template <typename T>
+        inline T ScalarSum(const T* p, size_t n, T init) noexcept {
+            for (size_t i = 0; i < n; ++i) {
+                init = WrapAdd(init, p[i]);
+            }
+            return init;
+        }
+
+        template <typename T>
+        inline T ScalarDot(const T* a, const T* b, size_t n, T init) noexcept {
+            for (size_t i = 0; i < n; ++i) {
+                init = WrapAdd(init, WrapMul(a[i], b[i]));
+            }
+            return init;
+        }
+
+#if SIMD_X86
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+// AVX-512 intrinsics pass _mm512_undefined_* as unused merge sources
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+        // kernels over Ops (Reg, LANES, Load, Set1, Zero, Eq -> lane bitmask, Add, Mul, Min, Max, Store);
+        // always inlined into per-ISA entry points, so they are compiled for that ISA only
+
+        template <typename Ops, typename T>
+        __attribute__((always_inline)) inline const T* FindKernel(const T* p, size_t n, T value) {
+            constexpr size_t L = Ops::LANES;
+            const auto needle = Ops::Set1(value);
+            size_t i = 0;
+            // four registers per step, one branch
+            for (; i + 4 * L <= n; i += 4 * L) {
+                uint64_t m0 = Ops::Eq(Ops::Load(p + i), needle);
+                uint64_t m1 = Ops::Eq(Ops::Load(p + i + L), needle);
+                uint64_t m2 = Ops::Eq(Ops::Load(p + i + 2 * L), needle);
+                uint64_t m3 = Ops::Eq(Ops::Load(p + i + 3 * L), needle);
+                uint64_t mask = m0 | (m1 << L) | (m2 << 2 * L) | (m3 << 3 * L);
+                if (mask != 0) {
+                    return p + i + __builtin_ctzll(mask);
+                }
+            }
+            for (; i + L <= n; i += L) {
+                uint64_t mask = Ops::Eq(Ops::Load(p + i), needle);
+                if (mask != 0) {
+                    return p + i + __builtin_ctzll(mask);
+                }
+            }
+            return ScalarFind(p + i, n - i, value);
+        }
+
+        template <typename Ops, typename T>
+        __attribute__((always_inline)) inline size_t CountKernel(const T* p, size_t n, T value) {
+            constexpr size_t L = Ops::LANES;
+            const auto needle = Ops::Set1(value);
+            size_t count = 0;
+            size_t i = 0;
+            for (; i + L <= n; i += L) {
+                count += static_cast<size_t>(__builtin_popcountll(Ops::Eq(Ops::Load(p + i), needle)));
+            }
+            return count + ScalarCount(p + i, n - i, value);
+        }
+
+        template <typename Ops, typename T>
+        __attribute__((always_inline)) inline std::pair<T, T> MinMaxKernel(const T* p, size_t n) {
+            constexpr size_t L = Ops::LANES;
+            if constexpr (!Ops::HAS_MIN_MAX) {
+                return ScalarMinMax(p + 1, n - 1, std::pair<T, T>(p[0], p[0]));
+            }
+            else {
+                if (n < L) {
+                    return ScalarMinMax(p + 1, n - 1, std::pair<T, T>(p[0], p[0]));
+                }
+                auto low = Ops::Load(p);
+                auto high = low;
+                size_t i = L;
+                for (; i + L <= n; i += L) {
+                    auto x = Ops::Load(p + i);
+                    low = Ops::Min(low, x);
+                    high = Ops::Max(high, x);
+                }
+                T lows[L];
+                T highs[L];
+                Ops::Store(lows, low);
+                Ops::Store(highs, high);
+                std::pair<T, T> result(lows[0], highs[0]);
+                for (size_t k = 1; k < L; ++k) {
+                    result.first = lows[k] < result.first ? lows[k] : result.first;
+                    result.second = result.second < highs[k] ? highs[k] : result.second;
+                }
+                return ScalarMinMax(p + i, n - i, result);
+            }
+        }
+
+        template <typename T, size_t L>
+        inline T SumLanes(const T (&lanes)[L]) noexcept {
+            T sum = T();
+            for (size_t k = 0; k < L; ++k) {
+                sum = WrapAdd(sum, lanes[k]);
+            }
+            return sum;
+        }
+
+        template <typename Ops, typename T>
+        __attribute__((always_inline)) inline T SumKernel(const T* p, size_t n) {
+            constexpr size_t L = Ops::LANES;
+            // two accumulators hide add latency
+            auto acc0 = Ops::Zero();
+            auto acc1 = Ops::Zero();
+            size_t i = 0;
+            for (; i + 2 * L <= n; i += 2 * L) {
+                acc0 = Ops::Add(acc0, Ops::Load(p + i));
+                acc1 = Ops::Add(acc1, Ops::Load(p + i + L));
+            }
+            for (; i + L <= n; i += L) {
+                acc0 = Ops::Add(acc0, Ops::Load(p + i));
+            }
+            T lanes[L];
+            Ops::Store(lanes, Ops::Add(acc0, acc1));
+            return ScalarSum(p + i, n - i, SumLanes(lanes));
+        }
+
+        template <typename Ops, typename T>
+        __attribute__((always_inline)) inline T DotKernel(const T* a, const T* b, size_t n) {
+            constexpr size_t L = Ops::LANES;
+            if constexpr (!Ops::HAS_MUL) {
+                return ScalarDot(a, b, n, T());
+            }
+            else {
+                auto acc0 = Ops::Zero();
+                auto acc1 = Ops::Zero();
+                size_t i = 0;
+                for (; i + 2 * L <= n; i += 2 * L) {
+                    acc0 = Ops::Add(acc0, Ops::Mul(Ops::Load(a + i), Ops::Load(b + i)));
+                    acc1 = Ops::Add(acc1, Ops::Mul(Ops::Load(a + i + L), Ops::Load(b + i + L)));
+                }
+                for (; i + L <= n; i += L) {
+                    acc0 = Ops::Add(acc0, Ops::Mul(Ops::Load(a + i), Ops::Load(b + i)));
+                }
+                T lanes[L];
+                Ops::Store(lanes, Ops::Add(acc0, acc1));
+                return ScalarDot(a + i, b + i, n - i, SumLanes(lanes));
+            }
+        }
+
+        // entry points of one ISA: kernels and Ops are flattened into them
+#define SIMD_DEFINE_ENTRIES(OPS)                                                        \
+        template <typename T>                                                           \
+        __attribute__((flatten)) const T* Find(const T* p, size_t n, T value) {         \
+            return FindKernel<OPS<T>>(p, n, value);                                     \
+        }                                                                               \
+        template <typename T>                                                           \
+        __attribute__((flatten)) size_t Count(const T* p, size_t n, T value) {          \
+            return CountKernel<OPS<T>>(p, n, value);                                    \
+        }                                                                               \
+        template <typename T>                                                           \
+        __attribute__((flatten)) std::pair<T, T> MinMax(const T* p, size_t n) {         \
+            return MinMaxKernel<OPS<T>>(p, n);                                          \
+        }                                                                               \
+        template <typename T>                                                           \
+        __attribute__((flatten)) T Sum(const T* p, size_t n) {                          \
+            return SumKernel<OPS<T>>(p, n);                                             \
+        }                                                                               \
+        template <typename T>                                                           \
+        __attribute__((flatten)) T Dot(const T* a, const T* b, size_t n) {              \
+            return DotKernel<OPS<T>>(a, b, n);                                          \
+        }
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+        namespace sse2 {
+
+            template <typename T>
+            struct Ops;
+
+            template <>
+            struct Ops<int32_t> {
+                using Reg = __m128i;
+                static constexpr size_t LANES = 4;
+                static constexpr bool HAS_MUL = false;      // mullo_epi32 is SSE4.1
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+                static void Store(int32_t* p, Reg r) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), r); }
+                static Reg Set1(int32_t v) { return _mm_set1_epi32(v); }
+                static Reg Zero() { return _mm_setzero_si128(); }
+                static uint64_t Eq(Reg a, Reg b) { return static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)))); }
+                static Reg Add(Reg a, Reg b) { return _mm_add_epi32(a, b); }
+                static Reg Mul(Reg a, Reg b);
+                // min / max by compare and select
+                static Reg Min(Reg a, Reg b) {
+                    Reg greater = _mm_cmpgt_epi32(a, b);
+                    return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+                }
+                static Reg Max(Reg a, Reg b) {
+                    Reg greater = _mm_cmpgt_epi32(a, b);
+                    return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+                }
+            };
+
+            template <>
+            struct Ops<int64_t> {
+                using Reg = __m128i;
+                static constexpr size_t LANES = 2;
+                static constexpr bool HAS_MUL = false;
+                static constexpr bool HAS_MIN_MAX = false;  // 64-bit compare is SSE4.2
+
+                static Reg Load(const int64_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+                static void Store(int64_t* p, Reg r) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), r); }
+                static Reg Set1(int64_t v) { return _mm_set1_epi64x(v); }
+                static Reg Zero() { return _mm_setzero_si128(); }
+                // both 32-bit halves equal
+                static uint64_t Eq(Reg a, Reg b) {
+                    Reg halves = _mm_cmpeq_epi32(a, b);
+                    halves = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+                    return static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(halves)));
+                }
+                static Reg Add(Reg a, Reg b) { return _mm_add_epi64(a, b); }
+                static Reg Mul(Reg a, Reg b);
+                static Reg Min(Reg a, Reg b);
+                static Reg Max(Reg a, Reg b);
+            };
+
+            template <>
+            struct Ops<float> {
+                using Reg = __m128;
+                static constexpr size_t LANES = 4;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const float* p) { return _mm_loadu_ps(p); }
+                static void Store(float* p, Reg r) { _mm_storeu_ps(p, r); }
+                static Reg Set1(float v) { return _mm_set1_ps(v); }
+                static Reg Zero() { return _mm_setzero_ps(); }
+                static uint64_t Eq(Reg a, Reg b) { return static_cast<uint64_t>(_mm_movemask_ps(_mm_cmpeq_ps(a, b))); }
+                static Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+            };
+
+            template <>
+            struct Ops<double> {
+                using Reg = __m128d;
+                static constexpr size_t LANES = 2;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const double* p) { return _mm_loadu_pd(p); }
+                static void Store(double* p, Reg r) { _mm_storeu_pd(p, r); }
+                static Reg Set1(double v) { return _mm_set1_pd(v); }
+                static Reg Zero() { return _mm_setzero_pd(); }
+                static uint64_t Eq(Reg a, Reg b) { return static_cast<uint64_t>(_mm_movemask_pd(_mm_cmpeq_pd(a, b))); }
+                static Reg Add(Reg a, Reg b) { return _mm_add_pd(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm_mul_pd(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm_min_pd(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm_max_pd(a, b); }
+            };
+
+            SIMD_DEFINE_ENTRIES(Ops)
+
+        }  // namespace sse2
+
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+        namespace avx2 {
+
+            template <typename T>
+            struct Ops;
+
+            template <>
+            struct Ops<int32_t> {
+                using Reg = __m256i;
+                static constexpr size_t LANES = 8;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+                static void Store(int32_t* p, Reg r) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), r); }
+                static Reg Set1(int32_t v) { return _mm256_set1_epi32(v); }
+                static Reg Zero() { return _mm256_setzero_si256(); }
+                static uint64_t Eq(Reg a, Reg b) { return static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)))); }
+                static Reg Add(Reg a, Reg b) { return _mm256_add_epi32(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm256_mullo_epi32(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+            };
+
+            template <>
+            struct Ops<int64_t> {
+                using Reg = __m256i;
+                static constexpr size_t LANES = 4;
+                static constexpr bool HAS_MUL = false;      // mullo_epi64 is AVX-512DQ
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const int64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+                static void Store(int64_t* p, Reg r) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), r); }
+                static Reg Set1(int64_t v) { return _mm256_set1_epi64x(v); }
+                static Reg Zero() { return _mm256_setzero_si256(); }
+                static uint64_t Eq(Reg a, Reg b) { return static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)))); }
+                static Reg Add(Reg a, Reg b) { return _mm256_add_epi64(a, b); }
+                static Reg Mul(Reg a, Reg b);
+                static Reg Min(Reg a, Reg b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+                static Reg Max(Reg a, Reg b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+            };
+
+            template <>
+            struct Ops<float> {
+                using Reg = __m256;
+                static constexpr size_t LANES = 8;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+                static void Store(float* p, Reg r) { _mm256_storeu_ps(p, r); }
+                static Reg Set1(float v) { return _mm256_set1_ps(v); }
+                static Reg Zero() { return _mm256_setzero_ps(); }
+                static uint64_t Eq(Reg a, Reg b) { return static_cast<uint64_t>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))); }
+                static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+            };
+
+            template <>
+            struct Ops<double> {
+                using Reg = __m256d;
+                static constexpr size_t LANES = 4;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const double* p) { return _mm256_loadu_pd(p); }
+                static void Store(double* p, Reg r) { _mm256_storeu_pd(p, r); }
+                static Reg Set1(double v) { return _mm256_set1_pd(v); }
+                static Reg Zero() { return _mm256_setzero_pd(); }
+                static uint64_t Eq(Reg a, Reg b) { return static_cast<uint64_t>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))); }
+                static Reg Add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm256_mul_pd(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm256_min_pd(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm256_max_pd(a, b); }
+            };
+
+            SIMD_DEFINE_ENTRIES(Ops)
+
+        }  // namespace avx2
+
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq")
+
+        namespace avx512 {
+
+            template <typename T>
+            struct Ops;
+
+            template <>
+            struct Ops<int32_t> {
+                using Reg = __m512i;
+                static constexpr size_t LANES = 16;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const int32_t* p) { return _mm512_loadu_si512(p); }
+                static void Store(int32_t* p, Reg r) { _mm512_storeu_si512(p, r); }
+                static Reg Set1(int32_t v) { return _mm512_set1_epi32(v); }
+                static Reg Zero() { return _mm512_setzero_si512(); }
+                static uint64_t Eq(Reg a, Reg b) { return _mm512_cmpeq_epi32_mask(a, b); }
+                static Reg Add(Reg a, Reg b) { return _mm512_add_epi32(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm512_mullo_epi32(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm512_min_epi32(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm512_max_epi32(a, b); }
+            };
+
+            template <>
+            struct Ops<int64_t> {
+                using Reg = __m512i;
+                static constexpr size_t LANES = 8;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const int64_t* p) { return _mm512_loadu_si512(p); }
+                static void Store(int64_t* p, Reg r) { _mm512_storeu_si512(p, r); }
+                static Reg Set1(int64_t v) { return _mm512_set1_epi64(v); }
+                static Reg Zero() { return _mm512_setzero_si512(); }
+                static uint64_t Eq(Reg a, Reg b) { return _mm512_cmpeq_epi64_mask(a, b); }
+                static Reg Add(Reg a, Reg b) { return _mm512_add_epi64(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm512_mullo_epi64(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm512_min_epi64(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm512_max_epi64(a, b); }
+            };
+
+            template <>
+            struct Ops<float> {
+                using Reg = __m512;
+                static constexpr size_t LANES = 16;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const float* p) { return _mm512_loadu_ps(p); }
+                static void Store(float* p, Reg r) { _mm512_storeu_ps(p, r); }
+                static Reg Set1(float v) { return _mm512_set1_ps(v); }
+                static Reg Zero() { return _mm512_setzero_ps(); }
+                static uint64_t Eq(Reg a, Reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+                static Reg Add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm512_min_ps(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm512_max_ps(a, b); }
+            };
+
+            template <>
+            struct Ops<double> {
+                using Reg = __m512d;
+                static constexpr size_t LANES = 8;
+                static constexpr bool HAS_MUL = true;
+                static constexpr bool HAS_MIN_MAX = true;
+
+                static Reg Load(const double* p) { return _mm512_loadu_pd(p); }
+                static void Store(double* p, Reg r) { _mm512_storeu_pd(p, r); }
+                static Reg Set1(double v) { return _mm512_set1_pd(v); }
+                static Reg Zero() { return _mm512_setzero_pd(); }
+                static uint64_t Eq(Reg a, Reg b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+                static Reg Add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+                static Reg Mul(Reg a, Reg b) { return _mm512_mul_pd(a, b); }
+                static Reg Min(Reg a, Reg b) { return _mm512_min_pd(a, b); }
+                static Reg Max(Reg a, Reg b) { return _mm512_max_pd(a, b); }
+            };
+
+            SIMD_DEFINE_ENTRIES(Ops)
+
+        }  // namespace avx512
+
+#pragma GCC pop_options
+#undef SIMD_DEFINE_ENTRIES
+#pragma GCC diagnostic pop
+#endif  // SIMD_X86
+
+        inline std::atomic<Isa>& ActiveIsa() noexcept {
+            static std::atomic<Isa> isa{ DetectIsa() };
+            return isa;
+        }
+
+    }  // namespace detail
+
+    inline Isa DetectIsa() noexcept {
+#if SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+            return Isa::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return Isa::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return Isa::SSE2;
+        }
+#endif
+        return Isa::SCALAR;
+    }
+
+    inline Isa GetIsa() noexcept {
+        return detail::ActiveIsa().load(std::memory_order_relaxed);
+    }
+
+    inline void SetIsa(Isa isa) noexcept {
+        detail::ActiveIsa().store(std::min(isa, DetectIsa()), std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    inline const T* Find(const T* first, const T* last, T value) {
+        static_assert(is_simd_type_v<T>, "simd kernels take int32_t, int64_t, float or double");
+        const size_t n = last - first;
+#if SIMD_X86
+        switch (GetIsa()) {
+        case Isa::AVX512:
+            return detail::avx512::Find(first, n, value);
+        case Isa::AVX2:
+            return detail::avx2::Find(first, n, value);
+        case Isa::SSE2:
+            return detail::sse2::Find(first, n, value);
+        case Isa::SCALAR:
+            break;
+        }
+#endif
+        return detail::ScalarFind(first, n, value);
+    }
+
+    template <typename T>
+    inline size_t Count(const T* first, const T* last, T value) {
+        static_assert(is_simd_type_v<T>, "simd kernels take int32_t, int64_t, float or double");
+        const size_t n = last - first;
+#if SIMD_X86
+        switch (GetIsa()) {
+        case Isa::AVX512:
+            return detail::avx512::Count(first, n, value);
+        case Isa::AVX2:
+            return detail::avx2::Count(first, n, value);
+        case Isa::SSE2:
+            return detail::sse2::Count(first, n, value);
+        case Isa::SCALAR:
+            break;
+        }
+#endif
+        return detail::ScalarCount(first, n, value);
+    }
+
+    template <typename T>
+    inline bool Contains(const T* first, const T* last, T value) {
+        return Find(first, last, value) != last;
+    }
+
+    template <typename T>
+    inline std::pair<T, T> MinMax(const T* first, const T* last) {
+        static_assert(is_simd_type_v<T>, "simd kernels take int32_t, int64_t, float or double");
+        assert(first != last);
+        const size_t n = last - first;
+#if SIMD_X86
+        switch (GetIsa()) {
+        case Isa::AVX512:
+            return detail::avx512::MinMax(first, n);
+        case Isa::AVX2:
+            return detail::avx2::MinMax(first, n);
+        case Isa::SSE2:
+            return detail::sse2::MinMax(first, n);
+        case Isa::SCALAR:
+            break;
+        }
+#endif
+        return detail::ScalarMinMax(first + 1, n - 1, std::pair<T, T>(*first, *first));
+    }
+
+    template <typename T>
+    inline T Sum(const T* first, const T* last) {
+        static_assert(is_simd_type_v<T>, "simd kernels take int32_t, int64_t, float or double");
+        const size_t n = last - first;
+#if SIMD_X86
+        switch (GetIsa()) {
+        case Isa::AVX512:
+            return detail::avx512::Sum(first, n);
+        case Isa::AVX2:
+            return detail::avx2::Sum(first, n);
+        case Isa::SSE2:
+            return detail::sse2::Sum(first, n);
+        case Isa::SCALAR:
+            break;
+        }
+#endif
+        return detail::ScalarSum(first, n, T());
+    }
+
+    template <typename T>
+    inline T Dot(const T* first, const T* last, const T* other) {
+        static_assert(is_simd_type_v<T>, "simd kernels take int32_t, int64_t, float or double");
+        const size_t n = last - first;
+#if SIMD_X86
+        switch (GetIsa()) {
+        case Isa::AVX512:
+            return detail::avx512::Dot(first, other, n);
+        case Isa::AVX2:
+            return detail::avx2::Dot(first, other, n);
+        case Isa::SSE2:
+            return detail::sse2::Dot(first, other, n);
+        case Isa::SCALAR:
+            break;
+        }
+#endif
+        return detail::ScalarDot(first, other, n, T());
+    }
+
+    template <typename T, typename Alloc, typename Growth>
+    inline const T* Find(const Vector<T, Alloc, Growth>& v, typename detail::Identity<T>::type value) {
+        return Find(v.begin(), v.end(), value);
+    }
+
+    template <typename T, typename Alloc, typename Growth>
+    inline size_t Count(const Vector<T, Alloc, Growth>& v, typename detail::Identity<T>::type value) {
+        return Count(v.begin(), v.end(), value);
+    }
+
+    template <typename T, typename Alloc, typename Growth>
+    inline bool Contains(const Vector<T, Alloc, Growth>& v, typename detail::Identity<T>::type value) {
+        return Contains(v.begin(), v.end(), value);
+    }
+
+    template <typename T, typename Alloc, typename Growth>
+    inline std::pair<T, T> MinMax(const Vector<T, Alloc, Growth>& v) {
+        return MinMax(v.begin(), v.end());
+    }
+
+    template <typename T, typename Alloc, typename Growth>
+    inline T Sum(const Vector<T, Alloc, Growth>& v) {
+        return Sum(v.begin(), v.end());
+    }
+
+    template <typename T, typename Alloc, typename Growth, typename OtherAlloc, typename OtherGrowth>
+    inline T Dot(const Vector<T, Alloc, Growth>& v, const Vector<T, OtherAlloc, OtherGrowth>& other) {
+        assert(v.Size() == other.Size());
+        return Dot(v.begin(), v.end(), other.begin());
+    }
+
+}  // namespace simd
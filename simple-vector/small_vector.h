@@ -0,0 +1,356 @@
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <memory>
+#include <algorithm>
+
+#include "vector.h"
+
+// vector with inline storage for first N elements
+// spills to RawMemory on overflow, same interface, guarantees and growth policies as Vector
+template <typename T, size_t N, typename Growth = DoublingGrowth>
+class SmallVector {
+    static_assert(N > 0, "SmallVector needs at least one inline element");
+
+private:        // fields
+    // alignas - for correct memory align (same as Optional::data_)
+    alignas(T) char inline_[sizeof(T) * N];
+    RawMemory<T> heap_;
+    size_t size_ = 0;
+
+public:         // constructors
+    SmallVector() = default;
+    explicit SmallVector(size_t size);
+    SmallVector(const SmallVector& other);
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+    ~SmallVector();
+
+public:         // iterators
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+public:         // operators
+    const T& operator[](size_t index) const noexcept;
+    T& operator[](size_t index) noexcept;
+
+    SmallVector& operator=(const SmallVector& other);
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+
+public:         // methods
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+    // true while elements live in inline buffer
+    bool IsInline() const noexcept;
+    void Reserve(size_t new_capacity);
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+    void Resize(size_t new_size);
+    void PopBack() /* noexcept */;
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+    iterator Erase(const_iterator pos);
+    iterator Insert(const_iterator pos, const T& value);
+    iterator Insert(const_iterator pos, T&& value);
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args);
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args);
+
+private:        // methods
+    T* Data() noexcept;
+    const T* Data() const noexcept;
+    // Growth::Grow capacity for required elements, cut to max_size()
+    size_t GrowCapacity(size_t required) const noexcept;
+    // Growth::Fit capacity for required elements, cut to max_size()
+    size_t FitCapacity(size_t required) const noexcept;
+    // relocates elements into heap buffer of new_capacity
+    void Reallocate(size_t new_capacity);
+};
+
+template <typename T, size_t N, typename Growth>
+inline SmallVector<T, N, Growth>::SmallVector(size_t size) {
+    if (size > N) {
+        RawMemory<T> tmp(FitCapacity(size));
+        heap_.Swap(tmp);
+    }
+    std::uninitialized_value_construct_n(Data(), size);
+    size_ = size;
+}
+
+template <typename T, size_t N, typename Growth>
+inline SmallVector<T, N, Growth>::SmallVector(const SmallVector& other) {
+    if (other.size_ > N) {
+        RawMemory<T> tmp(FitCapacity(other.size_));
+        heap_.Swap(tmp);
+    }
+    std::uninitialized_copy_n(other.Data(), other.size_, Data());
+    size_ = other.size_;
+}
+
+template <typename T, size_t N, typename Growth>
+inline SmallVector<T, N, Growth>::SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (!other.IsInline()) {
+        heap_.Swap(other.heap_);
+        size_ = std::exchange(other.size_, 0);
+        return;
+    }
+    std::uninitialized_move_n(other.Data(), other.size_, Data());
+    size_ = other.size_;
+    std::destroy_n(other.Data(), other.size_);
+    other.size_ = 0;
+}
+
+template <typename T, size_t N, typename Growth>
+inline SmallVector<T, N, Growth>::~SmallVector() {
+    std::destroy_n(Data(), size_);
+}
+
+template <typename T, size_t N, typename Growth>
+inline T* SmallVector<T, N, Growth>::begin() noexcept {
+    return Data();
+}
+
+template <typename T, size_t N, typename Growth>
+inline T* SmallVector<T, N, Growth>::end() noexcept {
+    return Data() + size_;
+}
+
+template <typename T, size_t N, typename Growth>
+inline const T* SmallVector<T, N, Growth>::begin() const noexcept {
+    return Data();
+}
+
+template <typename T, size_t N, typename Growth>
+inline const T* SmallVector<T, N, Growth>::end() const noexcept {
+    return Data() + size_;
+}
+
+template <typename T, size_t N, typename Growth>
+inline const T* SmallVector<T, N, Growth>::cbegin() const noexcept {
+    return Data();
+}
+
+template <typename T, size_t N, typename Growth>
+inline const T* SmallVector<T, N, Growth>::cend() const noexcept {
+    return Data() + size_;
+}
+
+template <typename T, size_t N, typename Growth>
+inline const T& SmallVector<T, N, Growth>::operator[](size_t index) const noexcept {
+    return const_cast<SmallVector&>(*this)[index];
+}
+
+template <typename T, size_t N, typename Growth>
+inline T& SmallVector<T, N, Growth>::operator[](size_t index) noexcept {
+    assert(index < size_);
+    return Data()[index];
+}
+
+template <typename T, size_t N, typename Growth>
+inline SmallVector<T, N, Growth>& SmallVector<T, N, Growth>::operator=(const SmallVector& other) {
+    if (this != &other) {
+        if (other.size_ > Capacity()) {     // copy - move
+            SmallVector other_copy(other);
+            *this = std::move(other_copy);
+        }
+        else {
+            if (size_ > other.size_) {
+                std::copy(other.Data(), other.Data() + other.size_, Data());
+                std::destroy_n(Data() + other.size_, size_ - other.size_);
+            }
+            else {
+                std::copy(other.Data(), other.Data() + size_, Data());
+                std::uninitialized_copy_n(other.Data() + size_,
+                    other.size_ - size_,
+                    Data() + size_);
+            }
+            size_ = other.size_;
+        }
+    }
+    return *this;
+}
+
+template <typename T, size_t N, typename Growth>
+inline SmallVector<T, N, Growth>& SmallVector<T, N, Growth>::operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (this != &other) {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+        if (!other.IsInline()) {
+            // own heap buffer (if any) is released here
+            RawMemory<T> tmp;
+            tmp.Swap(heap_);
+            heap_.Swap(other.heap_);
+            size_ = std::exchange(other.size_, 0);
+        }
+        else {
+            // other's elements fit into any of our buffers
+            std::uninitialized_move_n(other.Data(), other.size_, Data());
+            size_ = other.size_;
+            std::destroy_n(other.Data(), other.size_);
+            other.size_ = 0;
+        }
+    }
+    return *this;
+}
+
+template <typename T, size_t N, typename Growth>
+inline size_t SmallVector<T, N, Growth>::Size() const noexcept {
+    return size_;
+}
+
+template <typename T, size_t N, typename Growth>
+inline size_t SmallVector<T, N, Growth>::Capacity() const noexcept {
+    return IsInline() ? N : heap_.Capacity();
+}
+
+template <typename T, size_t N, typename Growth>
+inline bool SmallVector<T, N, Growth>::IsInline() const noexcept {
+    return heap_.GetAddress() == nullptr;
+}
+
+template <typename T, size_t N, typename Growth>
+inline void SmallVector<T, N, Growth>::Reserve(size_t new_capacity) {
+    if (new_capacity <= Capacity()) {
+        return;
+    }
+    Reallocate(FitCapacity(new_capacity));
+}
+
+template <typename T, size_t N, typename Growth>
+inline void SmallVector<T, N, Growth>::Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (!IsInline() && !other.IsInline()) {
+        heap_.Swap(other.heap_);
+        std::swap(size_, other.size_);
+        return;
+    }
+    SmallVector tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+}
+
+template <typename T, size_t N, typename Growth>
+inline void SmallVector<T, N, Growth>::Resize(size_t new_size) {
+    if (Capacity() >= new_size) {
+        if (new_size > size_) {
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+        else {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        }
+    }
+    else {
+        Reallocate(GrowCapacity(new_size));
+        std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+    }
+    size_ = new_size;
+}
+
+template <typename T, size_t N, typename Growth>
+inline void SmallVector<T, N, Growth>::PopBack() {
+    if (size_ == 0) {
+        return;
+    }
+    --size_;
+    std::destroy_n(Data() + size_, 1);
+}
+
+template <typename T, size_t N, typename Growth>
+inline void SmallVector<T, N, Growth>::PushBack(const T& value) {
+    EmplaceBack(value);
+}
+
+template <typename T, size_t N, typename Growth>
+inline void SmallVector<T, N, Growth>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
+}
+
+template <typename T, size_t N, typename Growth>
+inline typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::Erase(const_iterator pos) {
+    assert(pos >= begin() && pos < end());
+    size_t dist = pos - begin();
+    if constexpr (is_trivially_relocatable_v<T>) {
+        T* It = begin() + dist;
+        std::destroy_at(It);
+        std::memmove(static_cast<void*>(It), static_cast<const void*>(It + 1),
+            (size_ - dist - 1) * sizeof(T));
+        --size_;
+    }
+    else {
+        std::move(begin() + dist + 1, end(), begin() + dist);
+        PopBack();
+    }
+    return begin() + dist;
+}
+
+template <typename T, size_t N, typename Growth>
+inline typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::Insert(const_iterator pos, const T& value) {
+    return Emplace(pos, value);
+}
+
+template <typename T, size_t N, typename Growth>
+inline typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::Insert(const_iterator pos, T&& value) {
+    return Emplace(pos, std::move(value));
+}
+
+template <typename T, size_t N, typename Growth>
+template <typename... Args>
+inline T& SmallVector<T, N, Growth>::EmplaceBack(Args&&... args) {
+    return *Emplace(end(), std::forward<Args>(args)...);
+}
+
+template <typename T, size_t N, typename Growth>
+template <typename... Args>
+inline typename SmallVector<T, N, Growth>::iterator SmallVector<T, N, Growth>::Emplace(const_iterator pos, Args&&... args) {
+    assert(pos >= begin() && pos <= end());     // <= end() because could be EmplaceBack()
+    size_t dist = pos - begin();
+
+    if (Capacity() > size_) {
+        EmplaceIntoSpare(Data(), size_, dist, std::forward<Args>(args)...);
+    }
+    else {
+        // new element is built first: args may refer to an element of this vector
+        RawMemory<T> tmp(GrowCapacity(size_ + 1));
+        new (tmp + dist) T(std::forward<Args>(args)...);
+        UninitializedRelocateAroundN(Data(), size_, dist, tmp.GetAddress());
+        heap_.Swap(tmp);
+    }
+    ++size_;
+    return Data() + dist;
+}
+
+template <typename T, size_t N, typename Growth>
+inline T* SmallVector<T, N, Growth>::Data() noexcept {
+    return IsInline() ? reinterpret_cast<T*>(inline_) : heap_.GetAddress();
+}
+
+template <typename T, size_t N, typename Growth>
+inline const T* SmallVector<T, N, Growth>::Data() const noexcept {
+    return const_cast<SmallVector&>(*this).Data();
+}
+
+template <typename T, size_t N, typename Growth>
+inline size_t SmallVector<T, N, Growth>::GrowCapacity(size_t required) const noexcept {
+    return GrowCapacityFor<Growth>(heap_.GetAllocator(), Capacity(), required, sizeof(T));
+}
+
+template <typename T, size_t N, typename Growth>
+inline size_t SmallVector<T, N, Growth>::FitCapacity(size_t required) const noexcept {
+    return FitCapacityFor<Growth>(heap_.GetAllocator(), required, sizeof(T));
+}
+
+template <typename T, size_t N, typename Growth>
+inline void SmallVector<T, N, Growth>::Reallocate(size_t new_capacity) {
+    RawMemory<T> tmp(new_capacity);
+    UninitializedRelocateN(Data(), size_, tmp.GetAddress());
+    heap_.Swap(tmp);
+}
@@ -0,0 +1,584 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+// view of contiguous elements, e.g. one column of SoaVector
+template <typename T>
+class Span {
+private:        // fields
+    T* data_ = nullptr;
+    size_t size_ = 0;
+
+public:         // constructors
+    Span() = default;
+    Span(T* data, size_t size) noexcept
+        : data_(data), size_(size) { }
+
+public:         // iterators
+    using iterator = T*;
+
+    iterator begin() const noexcept {
+        return data_;
+    }
+    iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+public:         // operators
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+public:         // methods
+    T* Data() const noexcept {
+        return data_;
+    }
+    size_t Size() const noexcept {
+        return size_;
+    }
+};
+
+// structure of arrays: every field lives in its own RawMemory column,
+// all columns share one size and capacity and grow together;
+// a loop over one field reads only that field's cache lines
+//     SoaVector<float, float, int> particles;
+//     particles.EmplaceBack(x, y, id);
+//     for (float& x : particles.Column<0>()) ...
+// element reference is a tuple of references (proxy), structured bindings work on it:
+//     for (auto [x, y, id] : particles) ...
+template <typename... Ts>
+class SoaVector {
+    static_assert(sizeof...(Ts) > 0, "SoaVector needs at least one column");
+
+public:         // types
+    template <size_t I>
+    using Element = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    using reference = std::tuple<Ts&...>;
+    using const_reference = std::tuple<const Ts&...>;
+
+    static constexpr size_t COLUMNS = sizeof...(Ts);
+
+private:        // types
+    template <bool IsConst>
+    class Iterator;
+
+    // bytes of one row, growth policy works in rows
+    static constexpr size_t ROW_SIZE = (sizeof(Ts) + ...);
+
+    // relocation of column can't throw, so it needs no rollback
+    template <typename T>
+    static constexpr bool is_nothrow_relocatable_v =
+        is_trivially_relocatable_v<T> ||
+        std::is_nothrow_move_constructible_v<T>;
+
+private:        // fields
+    std::tuple<RawMemory<Ts>...> columns_;
+    size_t size_ = 0;
+
+public:         // constructors
+    SoaVector() = default;
+    explicit SoaVector(size_t size);
+    SoaVector(const SoaVector& other);
+    SoaVector(SoaVector&& other) noexcept;
+    ~SoaVector();
+
+public:         // iterators
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+public:         // operators
+    const_reference operator[](size_t index) const noexcept;
+    reference operator[](size_t index) noexcept;
+
+    SoaVector& operator=(const SoaVector& other);
+    SoaVector& operator=(SoaVector&& other) noexcept;
+
+public:         // methods
+    size_t Size() const noexcept;
+    size_t Capacity() const noexcept;
+    // reallocates all columns at once, strong guarantee
+    void Reserve(size_t new_capacity);
+    void Swap(SoaVector& other) noexcept;
+    void Resize(size_t new_size);
+    void PopBack() /* noexcept */;
+    void Clear() noexcept;
+
+    // field I of row index
+    template <size_t I>
+    const Element<I>& Get(size_t index) const noexcept;
+    template <size_t I>
+    Element<I>& Get(size_t index) noexcept;
+
+    // all values of field I, valid until next reallocation
+    template <size_t I>
+    Span<const Element<I>> Column() const noexcept;
+    template <size_t I>
+    Span<Element<I>> Column() noexcept;
+
+    // one argument per column
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args);
+
+private:        // methods
+    template <size_t I>
+    Element<I>* ColumnData() noexcept;
+    template <size_t I>
+    const Element<I>* ColumnData() const noexcept;
+
+    // f(std::integral_constant<size_t, I>) for every column in order
+    template <typename F>
+    static void ForEachColumn(F&& f);
+    template <typename F, size_t... Is>
+    static void ForEachColumn(F& f, std::index_sequence<Is...>);
+
+    template <size_t... Is>
+    reference MakeReference(size_t index, std::index_sequence<Is...>) noexcept;
+    template <size_t... Is>
+    const_reference MakeReference(size_t index, std::index_sequence<Is...>) const noexcept;
+
+    // constructs row index, destroys constructed fields if one throws
+    template <size_t... Is, typename... Args>
+    void ConstructRow(size_t index, std::index_sequence<Is...>, Args&&... args);
+    void ValueConstructRow(size_t index);
+    // destroys [first, first + count) in first columns columns
+    void DestroyRange(size_t columns, size_t first, size_t count) noexcept;
+    void Reallocate(size_t new_capacity);
+};
+
+template <typename... Ts>
+template <bool IsConst>
+class SoaVector<Ts...>::Iterator {
+public:         // types
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::tuple<Ts...>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::conditional_t<IsConst, SoaVector::const_reference, SoaVector::reference>;
+    using Owner = std::conditional_t<IsConst, const SoaVector, SoaVector>;
+
+private:        // fields
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+
+public:         // constructors
+    Iterator() = default;
+    Iterator(Owner* owner, size_t index) noexcept
+        : owner_(owner), index_(index) { }
+    // iterator -> const_iterator
+    template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    Iterator(const Iterator<OtherConst>& other) noexcept
+        : owner_(other.owner_), index_(other.index_) { }
+
+public:         // operators
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+    reference operator[](difference_type offset) const noexcept {
+        return (*owner_)[index_ + offset];
+    }
+    Iterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    Iterator operator++(int) noexcept {
+        Iterator old = *this;
+        ++index_;
+        return old;
+    }
+    Iterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    Iterator operator--(int) noexcept {
+        Iterator old = *this;
+        --index_;
+        return old;
+    }
+    Iterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+    Iterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+    Iterator operator+(difference_type offset) const noexcept {
+        return Iterator(owner_, index_ + offset);
+    }
+    friend Iterator operator+(difference_type offset, const Iterator& it) noexcept {
+        return it + offset;
+    }
+    Iterator operator-(difference_type offset) const noexcept {
+        return Iterator(owner_, index_ - offset);
+    }
+    difference_type operator-(const Iterator& other) const noexcept {
+        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+    }
+    bool operator==(const Iterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    bool operator!=(const Iterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+    bool operator<(const Iterator& other) const noexcept {
+        return index_ < other.index_;
+    }
+    bool operator>(const Iterator& other) const noexcept {
+        return index_ > other.index_;
+    }
+    bool operator<=(const Iterator& other) const noexcept {
+        return index_ <= other.index_;
+    }
+    bool operator>=(const Iterator& other) const noexcept {
+        return index_ >= other.index_;
+    }
+
+private:
+    template <bool>
+    friend class Iterator;
+};
+
+template <typename... Ts>
+inline SoaVector<Ts...>::SoaVector(size_t size) {
+    // destructor doesn't run if constructor throws, columns free their memory themselves
+    try {
+        Resize(size);
+    }
+    catch (...) {
+        Clear();
+        throw;
+    }
+}
+
+template <typename... Ts>
+inline SoaVector<Ts...>::SoaVector(const SoaVector& other) {
+    Reserve(other.size_);
+    // column by column - sequential reads and writes
+    size_t copied = 0;
+    try {
+        ForEachColumn([this, &other, &copied](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            std::uninitialized_copy_n(other.template ColumnData<I>(), other.size_, ColumnData<I>());
+            ++copied;
+        });
+    }
+    catch (...) {
+        DestroyRange(copied, 0, other.size_);
+        throw;
+    }
+    size_ = other.size_;
+}
+
+template <typename... Ts>
+inline SoaVector<Ts...>::SoaVector(SoaVector&& other) noexcept
+    : columns_(std::move(other.columns_))
+    , size_(std::exchange(other.size_, 0)) {
+}
+
+template <typename... Ts>
+inline SoaVector<Ts...>::~SoaVector() {
+    Clear();
+}
+
+template <typename... Ts>
+inline typename SoaVector<Ts...>::iterator SoaVector<Ts...>::begin() noexcept {
+    return iterator(this, 0);
+}
+
+template <typename... Ts>
+inline typename SoaVector<Ts...>::iterator SoaVector<Ts...>::end() noexcept {
+    return iterator(this, size_);
+}
+
+template <typename... Ts>
+inline typename SoaVector<Ts...>::const_iterator SoaVector<Ts...>::begin() const noexcept {
+    return const_iterator(this, 0);
+}
+
+template <typename... Ts>
+inline typename SoaVector<Ts...>::const_iterator SoaVector<Ts...>::end() const noexcept {
+    return const_iterator(this, size_);
+}
+
+template <typename... Ts>
+inline typename SoaVector<Ts...>::const_iterator SoaVector<Ts...>::cbegin() const noexcept {
+    return begin();
+}
+
+template <typename... Ts>
+inline typename SoaVector<Ts...>::const_iterator SoaVector<Ts...>::cend() const noexcept {
+    return end();
+}
+
+template <typename... Ts>
+inline typename SoaVector<Ts...>::const_reference SoaVector<Ts...>::operator[](size_t index) const noexcept {
+    assert(index < size_);
+    return MakeReference(index, std::index_sequence_for<Ts...>());
+}
+
+template <typename... Ts>
+inline typename SoaVector<Ts...>::reference SoaVector<Ts...>::operator[](size_t index) noexcept {
+    assert(index < size_);
+    return MakeReference(index, std::index_sequence_for<Ts...>());
+}
+
+template <typename... Ts>
+inline SoaVector<Ts...>& SoaVector<Ts...>::operator=(const SoaVector& other) {
+    if (this != &other) {
+        SoaVector copy(other);
+        Swap(copy);
+    }
+    return *this;
+}
+
+template <typename... Ts>
+inline SoaVector<Ts...>& SoaVector<Ts...>::operator=(SoaVector&& other) noexcept {
+    if (this != &other) {
+        Clear();
+        columns_ = std::move(other.columns_);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+template <typename... Ts>
+inline size_t SoaVector<Ts...>::Size() const noexcept {
+    return size_;
+}
+
+template <typename... Ts>
+inline size_t SoaVector<Ts...>::Capacity() const noexcept {
+    return std::get<0>(columns_).Capacity();
+}
+
+template <typename... Ts>
+inline void SoaVector<Ts...>::Reserve(size_t new_capacity) {
+    if (new_capacity <= Capacity()) {
+        return;
+    }
+    Reallocate(DoublingGrowth::Fit(new_capacity, ROW_SIZE));
+}
+
+template <typename... Ts>
+inline void SoaVector<Ts...>::Swap(SoaVector& other) noexcept {
+    ForEachColumn([this, &other](auto column) {
+        constexpr size_t I = decltype(column)::value;
+        std::get<I>(columns_).Swap(std::get<I>(other.columns_));
+    });
+    std::swap(size_, other.size_);
+}
+
+template <typename... Ts>
+inline void SoaVector<Ts...>::Resize(size_t new_size) {
+    if (new_size > size_) {
+        Reserve(new_size);
+        for (; size_ < new_size; ++size_) {
+            ValueConstructRow(size_);
+        }
+    }
+    else {
+        DestroyRange(COLUMNS, new_size, size_ - new_size);
+        size_ = new_size;
+    }
+}
+
+template <typename... Ts>
+inline void SoaVector<Ts...>::PopBack() {
+    if (size_ == 0) {
+        return;
+    }
+    --size_;
+    DestroyRange(COLUMNS, size_, 1);
+}
+
+template <typename... Ts>
+inline void SoaVector<Ts...>::Clear() noexcept {
+    DestroyRange(COLUMNS, 0, size_);
+    size_ = 0;
+}
+
+template <typename... Ts>
+template <size_t I>
+inline const typename SoaVector<Ts...>::template Element<I>& SoaVector<Ts...>::Get(size_t index) const noexcept {
+    assert(index < size_);
+    return ColumnData<I>()[index];
+}
+
+template <typename... Ts>
+template <size_t I>
+inline typename SoaVector<Ts...>::template Element<I>& SoaVector<Ts...>::Get(size_t index) noexcept {
+    assert(index < size_);
+    return ColumnData<I>()[index];
+}
+
+template <typename... Ts>
+template <size_t I>
+inline Span<const typename SoaVector<Ts...>::template Element<I>> SoaVector<Ts...>::Column() const noexcept {
+    return Span<const Element<I>>(ColumnData<I>(), size_);
+}
+
+template <typename... Ts>
+template <size_t I>
+inline Span<typename SoaVector<Ts...>::template Element<I>> SoaVector<Ts...>::Column() noexcept {
+    return Span<Element<I>>(ColumnData<I>(), size_);
+}
+
+template <typename... Ts>
+template <typename... Args>
+inline typename SoaVector<Ts...>::reference SoaVector<Ts...>::EmplaceBack(Args&&... args) {
+    static_assert(sizeof...(Args) == COLUMNS, "EmplaceBack takes one argument per column");
+    if (size_ == Capacity()) {
+        // args may refer to elements: take them before columns move
+        std::tuple<Ts...> row(std::forward<Args>(args)...);
+        Reallocate(DoublingGrowth::Grow(Capacity(), size_ + 1, ROW_SIZE));
+        std::apply([this](Ts&... fields) {
+            ConstructRow(size_, std::index_sequence_for<Ts...>(), std::move(fields)...);
+        }, row);
+    }
+    else {
+        ConstructRow(size_, std::index_sequence_for<Ts...>(), std::forward<Args>(args)...);
+    }
+    ++size_;
+    return (*this)[size_ - 1];
+}
+
+template <typename... Ts>
+template <size_t I>
+inline typename SoaVector<Ts...>::template Element<I>* SoaVector<Ts...>::ColumnData() noexcept {
+    return std::get<I>(columns_).GetAddress();
+}
+
+template <typename... Ts>
+template <size_t I>
+inline const typename SoaVector<Ts...>::template Element<I>* SoaVector<Ts...>::ColumnData() const noexcept {
+    return std::get<I>(columns_).GetAddress();
+}
+
+template <typename... Ts>
+template <typename F>
+inline void SoaVector<Ts...>::ForEachColumn(F&& f) {
+    ForEachColumn(f, std::index_sequence_for<Ts...>());
+}
+
+template <typename... Ts>
+template <typename F, size_t... Is>
+inline void SoaVector<Ts...>::ForEachColumn(F& f, std::index_sequence<Is...>) {
+    (f(std::integral_constant<size_t, Is>()), ...);
+}
+
+template <typename... Ts>
+template <size_t... Is>
+inline typename SoaVector<Ts...>::reference SoaVector<Ts...>::MakeReference(size_t index, std::index_sequence<Is...>) noexcept {
+    return reference(ColumnData<Is>()[index]...);
+}
+
+template <typename... Ts>
+template <size_t... Is>
+inline typename SoaVector<Ts...>::const_reference SoaVector<Ts...>::MakeReference(size_t index, std::index_sequence<Is...>) const noexcept {
+    return const_reference(ColumnData<Is>()[index]...);
+}
+
+template <typename... Ts>
+template <size_t... Is, typename... Args>
+inline void SoaVector<Ts...>::ConstructRow(size_t index, std::index_sequence<Is...>, Args&&... args) {
+    size_t constructed = 0;
+    try {
+        ((new (ColumnData<Is>() + index) Element<Is>(std::forward<Args>(args)), ++constructed), ...);
+    }
+    catch (...) {
+        DestroyRange(constructed, index, 1);
+        throw;
+    }
+}
+
+template <typename... Ts>
+inline void SoaVector<Ts...>::ValueConstructRow(size_t index) {
+    size_t constructed = 0;
+    try {
+        ForEachColumn([this, index, &constructed](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            new (ColumnData<I>() + index) Element<I>();
+            ++constructed;
+        });
+    }
+    catch (...) {
+        DestroyRange(constructed, index, 1);
+        throw;
+    }
+}
+
+template <typename... Ts>
+inline void SoaVector<Ts...>::DestroyRange(size_t columns, size_t first, size_t count) noexcept {
+    ForEachColumn([this, &columns, first, count](auto column) {
+        constexpr size_t I = decltype(column)::value;
+        if (I < columns) {
+            std::destroy_n(ColumnData<I>() + first, count);
+        }
+    });
+}
+
+template <typename... Ts>
+inline void SoaVector<Ts...>::Reallocate(size_t new_capacity) {
+    // all allocations first: if one fails, nothing has moved
+    std::tuple<RawMemory<Ts>...> fresh{ RawMemory<Ts>(new_capacity)... };
+
+    // columns which relocation may throw: copied while every old element is still in place,
+    // so a failure destroys the copies and leaves *this untouched; move-only columns with
+    // throwing move go last, a failure there leaves their moved-from elements (like Vector)
+    bool built[COLUMNS] = {};
+    try {
+        ForEachColumn([this, &fresh, &built](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            if constexpr (!is_nothrow_relocatable_v<Element<I>> && std::is_copy_constructible_v<Element<I>>) {
+                std::uninitialized_copy_n(ColumnData<I>(), size_, std::get<I>(fresh).GetAddress());
+                built[I] = true;
+            }
+        });
+        ForEachColumn([this, &fresh, &built](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            if constexpr (!is_nothrow_relocatable_v<Element<I>> && !std::is_copy_constructible_v<Element<I>>) {
+                std::uninitialized_move_n(ColumnData<I>(), size_, std::get<I>(fresh).GetAddress());
+                built[I] = true;
+            }
+        });
+    }
+    catch (...) {
+        ForEachColumn([this, &fresh, &built](auto column) {
+            constexpr size_t I = decltype(column)::value;
+            if (built[I]) {
+                std::destroy_n(std::get<I>(fresh).GetAddress(), size_);
+            }
+        });
+        throw;
+    }
+
+    // nothing below throws
+    ForEachColumn([this, &fresh](auto column) {
+        constexpr size_t I = decltype(column)::value;
+        if constexpr (is_nothrow_relocatable_v<Element<I>>) {
+            UninitializedRelocateN(ColumnData<I>(), size_, std::get<I>(fresh).GetAddress());
+        }
+        else {
+            std::destroy_n(ColumnData<I>(), size_);
+        }
+        std::get<I>(columns_).Swap(std::get<I>(fresh));
+    });
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "vector.h"
+
+// allocator reserving a large virtual address range once (PROT_NONE) and
+// committing pages on demand through expand(), so Vector never relocates:
+// growth within reservation is always in place, elements keep their addresses,
+// max_size() keeps growth steps inside reservation
+// growth past reservation (or failed commit) throws std::bad_alloc (Linux only)
+template <typename T>
+class VirtualReserveAllocator {
+private:        // fields
+    size_t reserve_bytes_;
+
+public:         // types
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    static constexpr size_t DEFAULT_RESERVE = size_t(16) << 30;   // 16 GiB of address space
+
+public:         // constructors
+    explicit VirtualReserveAllocator(size_t reserve_bytes = DEFAULT_RESERVE) noexcept;
+    template <typename U>
+    VirtualReserveAllocator(const VirtualReserveAllocator<U>& other) noexcept;
+
+public:         // methods
+    T* allocate(size_t n);
+    void deallocate(T* p, size_t n) noexcept;
+    // commits pages up to new_n elements, buffer never moves:
+    // throws std::bad_alloc instead of letting Vector fall back to a new block
+    bool expand(T* p, size_t old_n, size_t new_n);
+    // same as MaxSize(), read by Vector through std::allocator_traits
+    size_t max_size() const noexcept;
+    size_t ReserveBytes() const noexcept;
+    // elements fitting into reservation
+    size_t MaxSize() const noexcept;
+
+private:        // methods
+    size_t ReservedLength() const noexcept;
+    static size_t PageRound(size_t bytes) noexcept;
+};
+
+template <typename T, typename U>
+bool operator==(const VirtualReserveAllocator<T>& lhs, const VirtualReserveAllocator<U>& rhs) noexcept;
+template <typename T, typename U>
+bool operator!=(const VirtualReserveAllocator<T>& lhs, const VirtualReserveAllocator<U>& rhs) noexcept;
+
+// Vector with stable element addresses for append-heavy use:
+//     StableVector<Record> log;                                            // 16 GiB reservation
+//     StableVector<Record> log(VirtualReserveAllocator<Record>(1 << 30));  // 1 GiB reservation
+template <typename T>
+using StableVector = Vector<T, VirtualReserveAllocator<T>>;
+
+template <typename T>
+inline VirtualReserveAllocator<T>::VirtualReserveAllocator(size_t reserve_bytes) noexcept
+    : reserve_bytes_(reserve_bytes) { }
+
+template <typename T>
+template <typename U>
+inline VirtualReserveAllocator<T>::VirtualReserveAllocator(const VirtualReserveAllocator<U>& other) noexcept
+    : reserve_bytes_(other.ReserveBytes()) { }
+
+template <typename T>
+inline T* VirtualReserveAllocator<T>::allocate(size_t n) {
+    if (n > MaxSize()) {
+        throw std::bad_alloc();
+    }
+    void* p = mmap(nullptr, ReservedLength(), PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    if (mprotect(p, PageRound(n * sizeof(T)), PROT_READ | PROT_WRITE) != 0) {
+        munmap(p, ReservedLength());
+        throw std::bad_alloc();
+    }
+    return static_cast<T*>(p);
+}
+
+template <typename T>
+inline void VirtualReserveAllocator<T>::deallocate(T* p, size_t /*n*/) noexcept {
+    munmap(p, ReservedLength());
+}
+
+template <typename T>
+inline bool VirtualReserveAllocator<T>::expand(T* p, size_t old_n, size_t new_n) {
+    if (new_n > MaxSize()) {
+        throw std::bad_alloc();
+    }
+    const size_t committed = PageRound(old_n * sizeof(T));
+    const size_t required = PageRound(new_n * sizeof(T));
+    if (required > committed) {
+        char* begin = reinterpret_cast<char*>(p) + committed;
+        if (mprotect(begin, required - committed, PROT_READ | PROT_WRITE) != 0) {
+            throw std::bad_alloc();
+        }
+    }
+    return true;
+}
+
+template <typename T>
+inline size_t VirtualReserveAllocator<T>::max_size() const noexcept {
+    return MaxSize();
+}
+
+template <typename T>
+inline size_t VirtualReserveAllocator<T>::ReserveBytes() const noexcept {
+    return reserve_bytes_;
+}
+
+template <typename T>
+inline size_t VirtualReserveAllocator<T>::MaxSize() const noexcept {
+    return ReservedLength() / sizeof(T);
+}
+
+template <typename T>
+inline size_t VirtualReserveAllocator<T>::ReservedLength() const noexcept {
+    return PageRound(reserve_bytes_);
+}
+
+template <typename T>
+inline size_t VirtualReserveAllocator<T>::PageRound(size_t bytes) noexcept {
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return (bytes + page_size - 1) & ~(page_size - 1);
+}
+
+template <typename T, typename U>
+inline bool operator==(const VirtualReserveAllocator<T>& lhs, const VirtualReserveAllocator<U>& rhs) noexcept {
+    return lhs.ReserveBytes() == rhs.ReserveBytes();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const VirtualReserveAllocator<T>& lhs, const VirtualReserveAllocator<U>& rhs) noexcept {
+    return !(lhs == rhs);
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "vector.h"
+
+// fixed set of worker threads taking tasks from one queue
+class ThreadPool {
+private:        // types
+    // state of one ParallelFor, shared with helper tasks which may start after it returns
+    struct LoopState {
+        size_t count = 0;
+        size_t chunks = 0;
+        size_t grain = 0;
+        std::function<void(size_t, size_t)> body;
+        std::atomic<size_t> next_chunk{ 0 };
+        std::atomic<bool> failed{ false };
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t finished = 0;
+        std::exception_ptr error;
+
+        void Run();
+    };
+
+private:        // fields
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_ = false;
+    Vector<std::thread> workers_;
+
+public:         // constructors
+    explicit ThreadPool(size_t threads);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+
+    ~ThreadPool();
+
+public:         // operators
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+public:         // methods
+    size_t Size() const noexcept;
+    void Submit(std::function<void()> task);
+
+    // calls body(begin, end) for chunks of [0, count) of grain indices,
+    // calling thread takes chunks too, so nested loops can't deadlock;
+    // first exception from body is rethrown after remaining chunks are skipped
+    void ParallelFor(size_t count, size_t grain, std::function<void(size_t, size_t)> body);
+
+private:        // methods
+    void WorkerLoop();
+};
+
+// pool shared by parallel algorithms: one thread per core, calling thread included
+ThreadPool& DefaultThreadPool();
+
+inline void ThreadPool::LoopState::Run() {
+    size_t finished_here = 0;
+    for (size_t chunk = next_chunk.fetch_add(1); chunk < chunks; chunk = next_chunk.fetch_add(1)) {
+        if (!failed.load(std::memory_order_relaxed)) {
+            try {
+                size_t begin = chunk * grain;
+                body(begin, std::min(count, begin + grain));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        ++finished_here;
+    }
+    if (finished_here != 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished += finished_here;
+        if (finished == chunks) {
+            done.notify_all();
+        }
+    }
+}
+
+inline ThreadPool::ThreadPool(size_t threads) {
+    workers_.Reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.EmplaceBack([this] { WorkerLoop(); });
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+inline size_t ThreadPool::Size() const noexcept {
+    return workers_.Size();
+}
+
+inline void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+inline void ThreadPool::ParallelFor(size_t count, size_t grain, std::function<void(size_t, size_t)> body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max(grain, size_t(1));
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || workers_.Size() == 0) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            body(begin, std::min(count, begin + grain));
+        }
+        return;
+    }
+
+    auto state = std::make_shared<LoopState>();
+    state->count = count;
+    state->chunks = chunks;
+    state->grain = grain;
+    state->body = std::move(body);
+    const size_t helpers = std::min(chunks - 1, workers_.Size());
+    for (size_t i = 0; i < helpers; ++i) {
+        Submit([state] { state->Run(); });
+    }
+    state->Run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state] { return state->finished == state->chunks; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+inline void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+inline ThreadPool& DefaultThreadPool() {
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
@@ -1,23 +1,100 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <new>
+#include <stdexcept>
 #include <utility>
 #include <memory>
+#include <memory_resource>
 #include <iostream>
 #include <algorithm>
 
-// raw memory wrapper
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// copies of at least this many bytes use non-temporal stores (x86 with SSE2),
+// so a big snapshot doesn't evict the working set from cache; 0 turns it off
+#ifndef VECTOR_NONTEMPORAL_COPY_THRESHOLD
+#define VECTOR_NONTEMPORAL_COPY_THRESHOLD (size_t(32) << 20)
+#endif
+
+// true if object can be moved to other address by memcpy, old copy isn't destroyed
+// automatic for trivially copyable types, opt-in for others:
+//     template <> struct IsTriviallyRelocatable<MyHandle> : std::true_type {};
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename D>
+struct IsTriviallyRelocatable<std::unique_ptr<T, D>> : IsTriviallyRelocatable<D> {};
+
 template <typename T>
+struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = IsTriviallyRelocatable<T>::value;
+
+// memcpy with stores bypassing cache, plain memcpy without SSE2
+void CopyNonTemporal(void* dst, const void* src, size_t bytes) noexcept;
+
+// memcpy, or CopyNonTemporal from VECTOR_NONTEMPORAL_COPY_THRESHOLD bytes
+void BulkCopy(void* dst, const void* src, size_t bytes) noexcept;
+
+// moves n elements into uninitialized dst, copies instead if move may throw
+template <typename T>
+void UninitializedMoveIfNoexceptN(T* src, size_t n, T* dst);
+
+// moves n elements into uninitialized dst and destroys sources
+// copies instead of move if move may throw, sources are untouched on exception
+template <typename T>
+void UninitializedRelocateN(T* src, size_t n, T* dst);
+
+// relocates n elements of src into dst around dst[gap], where caller has built new element,
+// on exception destroys dst[gap] too, sources are untouched
+template <typename T>
+void UninitializedRelocateAroundN(T* src, size_t n, size_t gap, T* dst);
+
+// builds element at data[pos] shifting [pos, n) right into spare slot data[n],
+// args may refer to an element
+template <typename T, typename... Args>
+void EmplaceIntoSpare(T* data, size_t n, size_t pos, Args&&... args);
+
+// true if allocator can grow a block in place: alloc.expand(p, old_n, new_n) -> bool,
+// expand may throw instead of returning false if block must never move
+template <typename Alloc, typename T, typename = void>
+struct AllocatorHasExpand : std::false_type {};
+
+template <typename Alloc, typename T>
+struct AllocatorHasExpand<Alloc, T, std::void_t<decltype(
+    std::declval<Alloc&>().expand(std::declval<T*>(), size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// true if allocator can grow a block moving its bytes (like realloc):
+// alloc.reallocate(p, old_n, new_n) -> T*, only used for trivially relocatable T
+template <typename Alloc, typename T, typename = void>
+struct AllocatorHasReallocate : std::false_type {};
+
+template <typename Alloc, typename T>
+struct AllocatorHasReallocate<Alloc, T, std::void_t<decltype(
+    std::declval<Alloc&>().reallocate(std::declval<T*>(), size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// raw memory wrapper
+// Alloc - standard allocator, all memory requests go through std::allocator_traits
+template <typename T, typename Alloc = std::allocator<T>>
 class RawMemory {
 private:        // fields
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
+    Alloc alloc_;
 
 public:         // constructors
     RawMemory() = default;
-    explicit RawMemory(size_t capacity);
+    explicit RawMemory(const Alloc& alloc);
+    explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc());
 
     RawMemory(const RawMemory&) = delete;
     RawMemory(RawMemory&& other) noexcept;
@@ -35,27 +112,129 @@ public:         // operators
     RawMemory& operator=(RawMemory&& other) noexcept;
 
 public:         // methods
+    // swaps buffers only, allocators must be equal (or swapped by SwapAllocator)
     void Swap(RawMemory& other) noexcept;
+    void SwapAllocator(RawMemory& other) noexcept;
+    // grows buffer without moving it, false if allocator can't do it
+    bool TryExpand(size_t new_capacity);
+    // grows buffer by allocator's reallocate (bytes may move), false if allocator can't
+    // elements must be trivially relocatable
+    bool TryReallocate(size_t new_capacity);
     const T* GetAddress() const noexcept;
     T* GetAddress() noexcept;
     size_t Capacity() const;
+    const Alloc& GetAllocator() const noexcept;
 
 private:        // methods
-    static T* Allocate(size_t n);
-    static void Deallocate(T* buf) noexcept;
+    T* Allocate(size_t n);
+    void Deallocate(T* buf, size_t n) noexcept;
 };
 
-template <typename T>
+// growth policies - how much capacity Vector takes when it runs out of it
+//     Grow(capacity, required, elem_size) - amortized growth (Emplace, Resize), >= required
+//     Fit(required, elem_size)            - explicit request (Reserve, constructors), >= required
+// optional:
+//     Shrink(capacity, size, elem_size)   - capacity to keep after elements are erased,
+//                                           Vector reallocates down if it is less than capacity
+
+// capacity * 2
+struct DoublingGrowth {
+    static size_t Grow(size_t capacity, size_t required, size_t elem_size) noexcept;
+    static size_t Fit(size_t required, size_t elem_size) noexcept;
+};
+
+// capacity * 1.5, freed blocks can be reused by later growth steps
+struct OneAndHalfGrowth {
+    static size_t Grow(size_t capacity, size_t required, size_t elem_size) noexcept;
+    static size_t Fit(size_t required, size_t elem_size) noexcept;
+};
+
+// rounds Base's capacity up to allocator size class:
+// power of two bytes below page size, whole pages above it
+template <typename Base = DoublingGrowth, size_t PageSize = 4096>
+struct SizeClassGrowth {
+    static size_t Grow(size_t capacity, size_t required, size_t elem_size) noexcept;
+    static size_t Fit(size_t required, size_t elem_size) noexcept;
+
+private:
+    static size_t RoundUp(size_t n, size_t elem_size) noexcept;
+};
+
+// Base's growth, but one step never adds more than MaxStepBytes
+// (linear growth for very large vectors)
+template <size_t MaxStepBytes = (size_t(64) << 20), typename Base = DoublingGrowth>
+struct CappedGrowth {
+    static size_t Grow(size_t capacity, size_t required, size_t elem_size) noexcept;
+    static size_t Fit(size_t required, size_t elem_size) noexcept;
+};
+
+// Base's growth, plus automatic shrink: when size drops below capacity / Divisor,
+// capacity is cut to size * 2 (but not below MinBytes), so the next shrink or growth
+// needs size to change by a factor of two - no reallocations around one boundary
+template <size_t Divisor = 4, typename Base = DoublingGrowth, size_t MinBytes = 256>
+struct ShrinkingGrowth {
+    static_assert(Divisor > 2, "shrink threshold must be below half of capacity");
+
+    static size_t Grow(size_t capacity, size_t required, size_t elem_size) noexcept;
+    static size_t Fit(size_t required, size_t elem_size) noexcept;
+    static size_t Shrink(size_t capacity, size_t size, size_t elem_size) noexcept;
+};
+
+// true if growth policy has Shrink(capacity, size, elem_size)
+template <typename Growth, typename = void>
+struct GrowthHasShrink : std::false_type {};
+
+template <typename Growth>
+struct GrowthHasShrink<Growth, std::void_t<decltype(Growth::Shrink(size_t{}, size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// Growth::Grow capacity for required elements, cut to allocator's max_size()
+template <typename Growth, typename Alloc>
+size_t GrowCapacityFor(const Alloc& alloc, size_t capacity, size_t required, size_t elem_size) noexcept;
+
+// Growth::Fit capacity for required elements, cut to allocator's max_size()
+template <typename Growth, typename Alloc>
+size_t FitCapacityFor(const Alloc& alloc, size_t required, size_t elem_size) noexcept;
+
+// tag for default-initialized elements: trivial types are left uninitialized
+//     Vector<char> buffer(size, default_init);   // no zero-fill before read()
+struct DefaultInit {
+    explicit DefaultInit() = default;
+};
+inline constexpr DefaultInit default_init{};
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
 class Vector {
+private:        // types
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    // forward iterator giving one value count times, for Insert(pos, n, value) and Assign(n, value)
+    class RepeatIterator;
+
+    template <typename It>
+    using RequireInputIterator = std::enable_if_t<std::is_convertible_v<
+        typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>>;
+
+    template <typename It>
+    static constexpr bool is_forward_iterator_v = std::is_convertible_v<
+        typename std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>;
+
 private:        // fields
-    RawMemory<T> data_;
+    RawMemory<T, Alloc> data_;
     size_t size_ = 0;
 
 public:         // constructors
+    using allocator_type = Alloc;
+
     Vector() = default;
-    explicit Vector(size_t size);
+    explicit Vector(const Alloc& alloc);
+    explicit Vector(size_t size, const Alloc& alloc = Alloc());
+    Vector(size_t size, DefaultInit, const Alloc& alloc = Alloc());
     Vector(const Vector& other);
+    Vector(const Vector& other, const Alloc& alloc);
     Vector(Vector&& other) noexcept;
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    Vector(InputIt first, InputIt last, const Alloc& alloc = Alloc());
     ~Vector();
 
 public:         // iterators
@@ -74,20 +253,54 @@ public:         // operators
     T& operator[](size_t index) noexcept;
     
     Vector& operator=(const Vector& other);
-    Vector& operator=(Vector&& other) noexcept;
+    // noexcept only if storage can be stolen without comparing allocators
+    Vector& operator=(Vector&& other) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value ||
+        AllocTraits::is_always_equal::value);
 
 public:         // methods
     size_t Size() const noexcept;
     size_t Capacity() const noexcept;
+    Alloc GetAllocator() const noexcept;
     void Reserve(size_t new_capacity);
+    // gives unused capacity back, down to Growth::Fit(Size())
+    void ShrinkToFit();
     void Swap(Vector& other) noexcept;
     void Resize(size_t new_size);
+    // new elements are default-initialized, i.e. left uninitialized for trivial types
+    void ResizeDefaultInit(size_t new_size);
+    // grows to new_size without initialization and calls filler(data, new_size),
+    // filler writes elements and returns final size <= new_size (trivial types only)
+    template <typename Filler>
+    void ResizeForOverwrite(size_t new_size, Filler filler);
     void PopBack() /* noexcept */;
     void PushBack(const T& value);
     void PushBack(T&& value);
+    // keeps capacity, also with shrinking growth policy
+    void Clear() noexcept;
     iterator Erase(const_iterator pos);
+    iterator Erase(const_iterator first, const_iterator last);
+    // O(1), last element takes place of erased one, order isn't kept
+    iterator SwapErase(const_iterator pos);
+    // erases elements matching pred in one pass, returns number of erased elements
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred);
+    // erases elements whose bits are set in mask (bit i of mask[i / 64] for index i),
+    // mask holds at least (Size() + 63) / 64 words, returns number of erased elements
+    size_t EraseMarked(const uint64_t* mask);
     iterator Insert(const_iterator pos, const T& value);
     iterator Insert(const_iterator pos, T&& value);
+    iterator Insert(const_iterator pos, size_t count, const T& value);
+
+    // range operations: forward iterators are counted first,
+    // so buffer grows once and tail is shifted once
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last);
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    void Append(InputIt first, InputIt last);
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    void Assign(InputIt first, InputIt last);
+    void Assign(size_t count, const T& value);
 
     template <typename... Args>
     iterator Emplace(const_iterator pos, Args&&... args);
@@ -95,258 +308,833 @@ public:         // methods
     T& EmplaceBack(Args&&... args);
 
 private:        // methods
+    // reallocates to smaller new_capacity, releases buffer for 0
+    void ShrinkTo(size_t new_capacity);
+    // applies Growth::Shrink if policy has it, keeps buffer if reallocation fails
+    void MaybeShrink() noexcept;
+    // Growth::Grow capacity for required elements, cut to allocator's max_size()
+    size_t GrowCapacity(size_t required) const noexcept;
+    // resizes with construct(first, count) for new elements
+    template <typename Construct>
+    void ResizeWith(size_t new_size, Construct construct);
+    // index of first bit equal to value in mask from index from, Size() if none
+    size_t FindBit(const uint64_t* mask, size_t from, bool value) const noexcept;
+    // inserts count elements of [first, ...) before begin() + dist
+    template <typename ForwardIt>
+    iterator InsertRange(size_t dist, ForwardIt first, size_t count);
+    template <typename ForwardIt>
+    static void UninitializedCopyRange(ForwardIt first, size_t count, T* dst);
+    // moves elements into buffer of new_capacity (or grows buffer in place)
+    void Reallocate(size_t new_capacity);
+    // Reallocate for caller that already failed TryExpand
+    void Relocate(size_t new_capacity);
     static void DestroyN(T* buf, size_t n) noexcept;
     static void Destroy(T* buf) noexcept;
 };
 
-template<typename T>
-inline RawMemory<T>::RawMemory(size_t capacity)
-    : buffer_(Allocate(capacity))
-    , capacity_(capacity) { }
+// Vector with memory from std::pmr::memory_resource:
+//     std::pmr::monotonic_buffer_resource arena;
+//     pmr::Vector<int> v(&arena);
+namespace pmr {
+    template <typename T>
+    using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>>;
+}
+
+template <typename T, typename Alloc, typename Growth>
+class Vector<T, Alloc, Growth>::RepeatIterator {
+public:         // types
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+private:        // fields
+    const T* value_ = nullptr;
+    size_t index_ = 0;
+
+public:         // constructors
+    RepeatIterator() = default;
+    RepeatIterator(const T* value, size_t index) noexcept
+        : value_(value), index_(index) { }
+
+public:         // operators
+    const T& operator*() const noexcept {
+        return *value_;
+    }
+    const T* operator->() const noexcept {
+        return value_;
+    }
+    RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    RepeatIterator operator++(int) noexcept {
+        RepeatIterator old = *this;
+        ++index_;
+        return old;
+    }
+    bool operator==(const RepeatIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    bool operator!=(const RepeatIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+};
 
-template<typename T>
-inline RawMemory<T>::RawMemory(RawMemory&& other) noexcept
+inline size_t DoublingGrowth::Grow(size_t capacity, size_t required, size_t /*elem_size*/) noexcept {
+    return std::max(required, capacity == 0 ? size_t(1) : capacity * 2);
+}
+
+inline size_t DoublingGrowth::Fit(size_t required, size_t /*elem_size*/) noexcept {
+    return required;
+}
+
+inline size_t OneAndHalfGrowth::Grow(size_t capacity, size_t required, size_t /*elem_size*/) noexcept {
+    return std::max(required, capacity < 2 ? capacity + 1 : capacity + capacity / 2);
+}
+
+inline size_t OneAndHalfGrowth::Fit(size_t required, size_t /*elem_size*/) noexcept {
+    return required;
+}
+
+template <typename Base, size_t PageSize>
+inline size_t SizeClassGrowth<Base, PageSize>::Grow(size_t capacity, size_t required, size_t elem_size) noexcept {
+    return RoundUp(Base::Grow(capacity, required, elem_size), elem_size);
+}
+
+template <typename Base, size_t PageSize>
+inline size_t SizeClassGrowth<Base, PageSize>::Fit(size_t required, size_t elem_size) noexcept {
+    return RoundUp(Base::Fit(required, elem_size), elem_size);
+}
+
+template <typename Base, size_t PageSize>
+inline size_t SizeClassGrowth<Base, PageSize>::RoundUp(size_t n, size_t elem_size) noexcept {
+    static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be power of two");
+    if (n == 0) {
+        return 0;
+    }
+    size_t bytes = n * elem_size;
+    size_t rounded = PageSize;
+    if (bytes <= PageSize) {
+        while (rounded / 2 >= bytes) {
+            rounded /= 2;
+        }
+    }
+    else {
+        rounded = (bytes + PageSize - 1) & ~(PageSize - 1);
+    }
+    return std::max(n, rounded / elem_size);
+}
+
+template <size_t MaxStepBytes, typename Base>
+inline size_t CappedGrowth<MaxStepBytes, Base>::Grow(size_t capacity, size_t required, size_t elem_size) noexcept {
+    size_t grown = Base::Grow(capacity, required, elem_size);
+    size_t max_step = std::max(MaxStepBytes / elem_size, size_t(1));
+    if (grown - capacity > max_step) {
+        grown = std::max(required, capacity + max_step);
+    }
+    return grown;
+}
+
+template <size_t MaxStepBytes, typename Base>
+inline size_t CappedGrowth<MaxStepBytes, Base>::Fit(size_t required, size_t elem_size) noexcept {
+    return Base::Fit(required, elem_size);
+}
+
+template <size_t Divisor, typename Base, size_t MinBytes>
+inline size_t ShrinkingGrowth<Divisor, Base, MinBytes>::Grow(size_t capacity, size_t required, size_t elem_size) noexcept {
+    return Base::Grow(capacity, required, elem_size);
+}
+
+template <size_t Divisor, typename Base, size_t MinBytes>
+inline size_t ShrinkingGrowth<Divisor, Base, MinBytes>::Fit(size_t required, size_t elem_size) noexcept {
+    return Base::Fit(required, elem_size);
+}
+
+template <size_t Divisor, typename Base, size_t MinBytes>
+inline size_t ShrinkingGrowth<Divisor, Base, MinBytes>::Shrink(size_t capacity, size_t size, size_t elem_size) noexcept {
+    if (size >= capacity / Divisor) {
+        return capacity;
+    }
+    size_t target = std::max(Base::Fit(size * 2, elem_size), MinBytes / elem_size);
+    return std::min(target, capacity);
+}
+
+inline void CopyNonTemporal(void* dst, const void* src, size_t bytes) noexcept {
+#if defined(__SSE2__)
+    char* out = static_cast<char*>(dst);
+    const char* in = static_cast<const char*>(src);
+    // streaming stores need 16-byte aligned destination
+    size_t head = std::min(bytes, (16 - (reinterpret_cast<uintptr_t>(out) & 15)) & 15);
+    std::memcpy(out, in, head);
+    out += head;
+    in += head;
+    bytes -= head;
+    for (; bytes >= 64; bytes -= 64, out += 64, in += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(out), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(out + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(out + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(out + 48), d);
+    }
+    // streaming stores are weakly ordered
+    _mm_sfence();
+    std::memcpy(out, in, bytes);
+#else
+    if (bytes != 0) {
+        std::memcpy(dst, src, bytes);
+    }
+#endif
+}
+
+inline void BulkCopy(void* dst, const void* src, size_t bytes) noexcept {
+    if (bytes == 0) {
+        return;
+    }
+    if (VECTOR_NONTEMPORAL_COPY_THRESHOLD != 0 && bytes >= VECTOR_NONTEMPORAL_COPY_THRESHOLD) {
+        CopyNonTemporal(dst, src, bytes);
+    }
+    else {
+        std::memcpy(dst, src, bytes);
+    }
+}
+
+template <typename T>
+inline void UninitializedMoveIfNoexceptN(T* src, size_t n, T* dst) {
+    if constexpr (
+        std::is_nothrow_move_constructible_v<T> ||
+        !std::is_copy_constructible_v<T>)
+    {
+        std::uninitialized_move_n(src, n, dst);
+    }
+    else {
+        std::uninitialized_copy_n(src, n, dst);
+    }
+}
+
+template <typename T>
+inline void UninitializedRelocateN(T* src, size_t n, T* dst) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if (n != 0) {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+        }
+    }
+    else {
+        UninitializedMoveIfNoexceptN(src, n, dst);
+        std::destroy_n(src, n);
+    }
+}
+
+template <typename T>
+inline void UninitializedRelocateAroundN(T* src, size_t n, size_t gap, T* dst) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        UninitializedRelocateN(src, gap, dst);
+        UninitializedRelocateN(src + gap, n - gap, dst + gap + 1);
+    }
+    else {
+        try {
+            UninitializedMoveIfNoexceptN(src, gap, dst);
+            try {
+                UninitializedMoveIfNoexceptN(src + gap, n - gap, dst + gap + 1);
+            }
+            catch (...) {
+                std::destroy_n(dst, gap);
+                throw;
+            }
+        }
+        catch (...) {
+            std::destroy_at(dst + gap);
+            throw;
+        }
+        std::destroy_n(src, n);
+    }
+}
+
+template <typename T, typename... Args>
+inline void EmplaceIntoSpare(T* data, size_t n, size_t pos, Args&&... args) {
+    if (pos == n) {
+        new (data + n) T(std::forward<Args>(args)...);
+    }
+    else if constexpr (is_trivially_relocatable_v<T>) {
+        // built aside, then relocated into the hole after one memmove
+        alignas(T) char slot[sizeof(T)];
+        T* value = new (slot) T(std::forward<Args>(args)...);
+        std::memmove(static_cast<void*>(data + pos + 1), static_cast<const void*>(data + pos),
+            (n - pos) * sizeof(T));
+        std::memcpy(static_cast<void*>(data + pos), static_cast<const void*>(value), sizeof(T));
+    }
+    else {
+        T tmp(std::forward<Args>(args)...);
+        new (data + n) T(std::move(data[n - 1]));
+        std::move_backward(data + pos, data + n - 1, data + n);
+        data[pos] = std::move(tmp);
+    }
+}
+
+template <typename Growth, typename Alloc>
+inline size_t GrowCapacityFor(const Alloc& alloc, size_t capacity, size_t required, size_t elem_size) noexcept {
+    // past max_size() growth would fail though required elements may still fit
+    const size_t max_size = std::allocator_traits<Alloc>::max_size(alloc);
+    return std::max(required, std::min(Growth::Grow(capacity, required, elem_size), max_size));
+}
+
+template <typename Growth, typename Alloc>
+inline size_t FitCapacityFor(const Alloc& alloc, size_t required, size_t elem_size) noexcept {
+    const size_t max_size = std::allocator_traits<Alloc>::max_size(alloc);
+    return std::max(required, std::min(Growth::Fit(required, elem_size), max_size));
+}
+
+template <typename T, typename Alloc>
+inline RawMemory<T, Alloc>::RawMemory(const Alloc& alloc)
+    : alloc_(alloc) { }
+
+template <typename T, typename Alloc>
+inline RawMemory<T, Alloc>::RawMemory(size_t capacity, const Alloc& alloc)
+    : alloc_(alloc) {
+    buffer_ = Allocate(capacity);
+    capacity_ = capacity;
+}
+
+template <typename T, typename Alloc>
+inline RawMemory<T, Alloc>::RawMemory(RawMemory&& other) noexcept
     : buffer_(std::exchange(other.buffer_, nullptr))
-    , capacity_(std::exchange(other.capacity_, 0)) {
+    , capacity_(std::exchange(other.capacity_, 0))
+    , alloc_(other.alloc_) {
 }
 
-template<typename T>
-inline RawMemory<T>::~RawMemory() {
-    Deallocate(buffer_);
+template <typename T, typename Alloc>
+inline RawMemory<T, Alloc>::~RawMemory() {
+    Deallocate(buffer_, capacity_);
 }
 
-template<typename T>
-inline Vector<T>::Vector(size_t size) 
-    : data_(size), size_(size) {
+template <typename T, typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth>::Vector(const Alloc& alloc)
+    : data_(alloc) { }
+
+template <typename T, typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth>::Vector(size_t size, const Alloc& alloc)
+    : data_(FitCapacityFor<Growth>(alloc, size, sizeof(T)), alloc), size_(size) {
     std::uninitialized_value_construct_n(data_.GetAddress(), size);
 }
 
-template<typename T>
-inline Vector<T>::Vector(const Vector& other) 
-    : data_(other.size_), size_(other.size_) {
-    std::uninitialized_copy_n(
-        other.data_.GetAddress(), 
-        other.size_, 
-        data_.GetAddress());
+template <typename T, typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth>::Vector(size_t size, DefaultInit, const Alloc& alloc)
+    : data_(FitCapacityFor<Growth>(alloc, size, sizeof(T)), alloc), size_(size) {
+    std::uninitialized_default_construct_n(data_.GetAddress(), size);
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth>::Vector(const Vector& other) 
+    : Vector(other, AllocTraits::select_on_container_copy_construction(
+        other.data_.GetAllocator())) { }
+
+template <typename T, typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth>::Vector(const Vector& other, const Alloc& alloc)
+    : data_(FitCapacityFor<Growth>(alloc, other.size_, sizeof(T)), alloc), size_(other.size_) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        BulkCopy(data_.GetAddress(), other.data_.GetAddress(), other.size_ * sizeof(T));
+    }
+    else {
+        std::uninitialized_copy_n(
+            other.data_.GetAddress(), 
+            other.size_, 
+            data_.GetAddress());
+    }
 }
 
-template<typename T>
-inline Vector<T>::Vector(Vector&& other) noexcept 
+template <typename T, typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth>::Vector(Vector&& other) noexcept 
     : data_(std::move(other.data_))
     , size_(std::exchange(other.size_, 0)) { }
 
-template <typename T>
-Vector<T>::~Vector() {
+template <typename T, typename Alloc, typename Growth>
+template <typename InputIt, typename>
+inline Vector<T, Alloc, Growth>::Vector(InputIt first, InputIt last, const Alloc& alloc)
+    : Vector(alloc) {
+    // delegated constructor: elements appended so far are destroyed on exception
+    Append(first, last);
+}
+
+template <typename T, typename Alloc, typename Growth>
+Vector<T, Alloc, Growth>::~Vector() {
     std::destroy_n(data_.GetAddress(), size_);
 }
 
-template<typename T>
-inline T* Vector<T>::begin() noexcept {
+template <typename T, typename Alloc, typename Growth>
+inline T* Vector<T, Alloc, Growth>::begin() noexcept {
     return data_.GetAddress();
 }
 
-template<typename T>
-inline T* Vector<T>::end() noexcept {
+template <typename T, typename Alloc, typename Growth>
+inline T* Vector<T, Alloc, Growth>::end() noexcept {
     return data_.GetAddress() + size_;
 }
 
-template<typename T>
-inline const T* Vector<T>::begin() const noexcept {
+template <typename T, typename Alloc, typename Growth>
+inline const T* Vector<T, Alloc, Growth>::begin() const noexcept {
     return data_.GetAddress();
 }
 
-template<typename T>
-inline const T* Vector<T>::end() const noexcept {
+template <typename T, typename Alloc, typename Growth>
+inline const T* Vector<T, Alloc, Growth>::end() const noexcept {
     return data_.GetAddress() + size_;
 }
 
-template<typename T>
-inline const T* Vector<T>::cbegin() const noexcept {
+template <typename T, typename Alloc, typename Growth>
+inline const T* Vector<T, Alloc, Growth>::cbegin() const noexcept {
     return data_.GetAddress();
 }
 
-template<typename T>
-inline const T* Vector<T>::cend() const noexcept {
+template <typename T, typename Alloc, typename Growth>
+inline const T* Vector<T, Alloc, Growth>::cend() const noexcept {
     return data_.GetAddress() + size_;
 }
 
-template <typename T>
-size_t Vector<T>::Size() const noexcept {
+template <typename T, typename Alloc, typename Growth>
+size_t Vector<T, Alloc, Growth>::Size() const noexcept {
     return size_;
 }
 
-template <typename T>
-size_t Vector<T>::Capacity() const noexcept {
+template <typename T, typename Alloc, typename Growth>
+size_t Vector<T, Alloc, Growth>::Capacity() const noexcept {
     return data_.Capacity();
 }
 
-template<typename T>
-inline void Vector<T>::Reserve(size_t new_capacity) {
+template <typename T, typename Alloc, typename Growth>
+inline Alloc Vector<T, Alloc, Growth>::GetAllocator() const noexcept {
+    return data_.GetAllocator();
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::Reserve(size_t new_capacity) {
     if (new_capacity <= data_.Capacity()) {
         return;
     }
-    RawMemory<T> tmp(new_capacity);
+    Reallocate(FitCapacityFor<Growth>(data_.GetAllocator(), new_capacity, sizeof(T)));
+}
 
-    if constexpr (
-        std::is_nothrow_move_constructible_v<T> ||
-        !std::is_copy_constructible_v<T>) 
-    {
-        std::uninitialized_move_n(data_.GetAddress(), size_, tmp.GetAddress());
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::ShrinkToFit() {
+    size_t new_capacity = Growth::Fit(size_, sizeof(T));
+    if (new_capacity < data_.Capacity()) {
+        ShrinkTo(new_capacity);
+    }
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::Swap(Vector& other) noexcept {
+    if constexpr (AllocTraits::propagate_on_container_swap::value) {
+        data_.SwapAllocator(other.data_);
     }
     else {
-        std::uninitialized_copy_n(data_.GetAddress(), size_, tmp.GetAddress());
+        // swapping vectors with unequal allocators is undefined
+        assert(data_.GetAllocator() == other.data_.GetAllocator());
     }
+    data_.Swap(other.data_);
+    std::swap(size_, other.size_);
+}
 
-    std::destroy_n(data_.GetAddress(), size_);
-    data_.Swap(tmp);
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::Resize(size_t new_size) {
+    ResizeWith(new_size, [](T* first, size_t count) {
+        std::uninitialized_value_construct_n(first, count);
+    });
 }
 
-template<typename T>
-inline void Vector<T>::Swap(Vector& other) noexcept {
-    data_.Swap(other.data_);
-    std::swap(size_, other.size_);
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::ResizeDefaultInit(size_t new_size) {
+    ResizeWith(new_size, [](T* first, size_t count) {
+        std::uninitialized_default_construct_n(first, count);
+    });
 }
 
-template<typename T>
-inline void Vector<T>::Resize(size_t new_size) {
+template <typename T, typename Alloc, typename Growth>
+template <typename Filler>
+inline void Vector<T, Alloc, Growth>::ResizeForOverwrite(size_t new_size, Filler filler) {
+    static_assert(std::is_trivial_v<T>,
+        "ResizeForOverwrite hands out uninitialized memory, T must be trivial");
+    if (new_size > data_.Capacity()) {
+        Reallocate(GrowCapacity(new_size));
+    }
+    // size is set after filler, exception leaves old elements as they were
+    size_t final_size = static_cast<size_t>(filler(data_.GetAddress(), new_size));
+    if (final_size > new_size) {
+        throw std::length_error("ResizeForOverwrite: filler returned size past new_size");
+    }
+    size_ = final_size;
+}
+
+template <typename T, typename Alloc, typename Growth>
+template <typename Construct>
+inline void Vector<T, Alloc, Growth>::ResizeWith(size_t new_size, Construct construct) {
     if (data_.Capacity() >= new_size) {
         if (new_size > size_) {
-            std::uninitialized_value_construct_n(
-                data_.GetAddress() + size_,
-                new_size - size_);
+            construct(data_.GetAddress() + size_, new_size - size_);
         }
         else {
             std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);            
+            size_ = new_size;
+            MaybeShrink();
+            return;
         }
     }
     else {
-        size_t new_capacity = new_size;
-        Reserve(new_capacity);
-        std::uninitialized_value_construct_n(
-            data_.GetAddress() + size_,
-            new_capacity - size_);
+        Reallocate(GrowCapacity(new_size));
+        construct(data_.GetAddress() + size_, new_size - size_);
     }
     size_ = new_size;
 }
 
-template <typename T>
-inline void Vector<T>::PushBack(const T& value) {
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::PushBack(const T& value) {
     EmplaceBack(value);
 }
 
-template <typename T>
-inline void Vector<T>::PushBack(T&& value) {
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::PushBack(T&& value) {
     EmplaceBack(std::move(value));
 }
 
-template<typename T>
-inline typename Vector<T>::iterator Vector<T>::Erase(typename Vector<T>::const_iterator pos) {
+template <typename T, typename Alloc, typename Growth>
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Erase(typename Vector<T, Alloc, Growth>::const_iterator pos) {
     assert(pos >= begin() && pos < end());
     size_t dist = pos - begin();
-    std::move(begin() + dist + 1, end(), begin() + dist);
+    if constexpr (is_trivially_relocatable_v<T>) {
+        // hole is closed by one memmove of the tail
+        T* It = begin() + dist;
+        std::destroy_at(It);
+        std::memmove(static_cast<void*>(It), static_cast<const void*>(It + 1),
+            (size_ - dist - 1) * sizeof(T));
+        --size_;
+        MaybeShrink();
+    }
+    else {
+        std::move(begin() + dist + 1, end(), begin() + dist);
+        PopBack();
+    }
+    return begin() + dist;
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::Clear() noexcept {
+    std::destroy_n(data_.GetAddress(), size_);
+    size_ = 0;
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Erase(
+    typename Vector<T, Alloc, Growth>::const_iterator first,
+    typename Vector<T, Alloc, Growth>::const_iterator last) {
+    assert(first >= begin() && first <= last && last <= end());
+    size_t dist = first - begin();
+    size_t count = last - first;
+    if (count == 0) {
+        return begin() + dist;
+    }
+    T* It = begin() + dist;
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::destroy_n(It, count);
+        std::memmove(static_cast<void*>(It), static_cast<const void*>(It + count),
+            (size_ - dist - count) * sizeof(T));
+    }
+    else {
+        std::move(It + count, end(), It);
+        std::destroy_n(end() - count, count);
+    }
+    size_ -= count;
+    MaybeShrink();
+    return begin() + dist;
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::SwapErase(
+    typename Vector<T, Alloc, Growth>::const_iterator pos) {
+    assert(pos >= begin() && pos < end());
+    size_t dist = pos - begin();
+    T* It = begin() + dist;
+    T* last = end() - 1;
+    if (It != last) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::destroy_at(It);
+            std::memcpy(static_cast<void*>(It), static_cast<const void*>(last), sizeof(T));
+            --size_;
+            MaybeShrink();
+            return begin() + dist;
+        }
+        else {
+            *It = std::move(*last);
+        }
+    }
     PopBack();
     return begin() + dist;
 }
 
-template<typename T>
-inline typename Vector<T>::iterator Vector<T>::Insert(typename Vector<T>::const_iterator pos, const T& value) {
+template <typename T, typename Alloc, typename Growth>
+template <typename Predicate>
+inline size_t Vector<T, Alloc, Growth>::EraseIf(Predicate pred) {
+    // pred is called once per element, and not copied: it may keep state
+    T* out = begin();
+    T* last = end();
+    while (out != last && !pred(*out)) {
+        ++out;
+    }
+    if (out == last) {
+        return 0;
+    }
+    if constexpr (is_trivially_relocatable_v<T>) {
+        // survivors are relocated bitwise over destroyed elements
+        std::destroy_at(out);
+        T* In = out + 1;
+        try {
+            for (; In != last; ++In) {
+                if (pred(*In)) {
+                    std::destroy_at(In);
+                }
+                else {
+                    std::memcpy(static_cast<void*>(out), static_cast<const void*>(In), sizeof(T));
+                    ++out;
+                }
+            }
+        }
+        catch (...) {
+            // close the gap, unchecked elements are kept
+            std::memmove(static_cast<void*>(out), static_cast<const void*>(In), (last - In) * sizeof(T));
+            size_ -= In - out;
+            throw;
+        }
+    }
+    else {
+        for (T* In = out + 1; In != last; ++In) {
+            if (!pred(*In)) {
+                *out = std::move(*In);
+                ++out;
+            }
+        }
+        std::destroy_n(out, last - out);
+    }
+    size_t erased = last - out;
+    size_ -= erased;
+    MaybeShrink();
+    return erased;
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline size_t Vector<T, Alloc, Growth>::EraseMarked(const uint64_t* mask) {
+    // works with runs: marked run is dropped, following unmarked run is shifted down
+    size_t out = FindBit(mask, 0, true);
+    size_t erase_begin = out;
+    T* data = begin();
+    while (erase_begin < size_) {
+        size_t keep_begin = FindBit(mask, erase_begin, false);
+        size_t keep_end = FindBit(mask, keep_begin, true);
+        size_t count = keep_end - keep_begin;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::destroy(data + erase_begin, data + keep_begin);
+            std::memmove(static_cast<void*>(data + out), static_cast<const void*>(data + keep_begin),
+                count * sizeof(T));
+        }
+        else {
+            std::move(data + keep_begin, data + keep_end, data + out);
+        }
+        out += count;
+        erase_begin = keep_end;
+    }
+    size_t erased = size_ - out;
+    if constexpr (!is_trivially_relocatable_v<T>) {
+        std::destroy_n(data + out, erased);
+    }
+    size_ = out;
+    MaybeShrink();
+    return erased;
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Insert(typename Vector<T, Alloc, Growth>::const_iterator pos, const T& value) {
     return Emplace(pos, value);
 }
 
-template<typename T>
-inline typename Vector<T>::iterator Vector<T>::Insert(typename Vector<T>::const_iterator pos, T&& value) {
+template <typename T, typename Alloc, typename Growth>
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Insert(typename Vector<T, Alloc, Growth>::const_iterator pos, T&& value) {
     return Emplace(pos, std::move(value));
 }
 
-template<typename T>
+template <typename T, typename Alloc, typename Growth>
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Insert(
+    typename Vector<T, Alloc, Growth>::const_iterator pos, size_t count, const T& value) {
+    assert(pos >= begin() && pos <= end());
+    // value may be an element of this vector
+    const T copy(value);
+    return InsertRange(pos - begin(), RepeatIterator(&copy, 0), count);
+}
+
+template <typename T, typename Alloc, typename Growth>
+template <typename InputIt, typename>
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Insert(
+    typename Vector<T, Alloc, Growth>::const_iterator pos, InputIt first, InputIt last) {
+    assert(pos >= begin() && pos <= end());
+    size_t dist = pos - begin();
+    if constexpr (is_forward_iterator_v<InputIt>) {
+        return InsertRange(dist, first, static_cast<size_t>(std::distance(first, last)));
+    }
+    else {
+        // single pass range: append, then rotate into place
+        size_t old_size = size_;
+        Append(first, last);
+        std::rotate(begin() + dist, begin() + old_size, end());
+        return begin() + dist;
+    }
+}
+
+template <typename T, typename Alloc, typename Growth>
+template <typename InputIt, typename>
+inline void Vector<T, Alloc, Growth>::Append(InputIt first, InputIt last) {
+    if constexpr (is_forward_iterator_v<InputIt>) {
+        InsertRange(size_, first, static_cast<size_t>(std::distance(first, last)));
+    }
+    else {
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+}
+
+template <typename T, typename Alloc, typename Growth>
+template <typename InputIt, typename>
+inline void Vector<T, Alloc, Growth>::Assign(InputIt first, InputIt last) {
+    if constexpr (is_forward_iterator_v<InputIt>) {
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        if (count > data_.Capacity()) {
+            Vector tmp(data_.GetAllocator());
+            tmp.Reserve(count);
+            UninitializedCopyRange(first, count, tmp.data_.GetAddress());
+            tmp.size_ = count;
+            data_.Swap(tmp.data_);
+            std::swap(size_, tmp.size_);
+        }
+        else if (count <= size_) {
+            T* new_end = std::copy(first, last, begin());
+            std::destroy_n(new_end, size_ - count);
+            size_ = count;
+        }
+        else {
+            InputIt mid = std::next(first, size_);
+            std::copy(first, mid, begin());
+            UninitializedCopyRange(mid, count - size_, end());
+            size_ = count;
+        }
+    }
+    else {
+        Clear();
+        Append(first, last);
+    }
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::Assign(size_t count, const T& value) {
+    const T copy(value);
+    Assign(RepeatIterator(&copy, 0), RepeatIterator(&copy, count));
+}
+
+template <typename T, typename Alloc, typename Growth>
 template<typename... Args>
-inline T& Vector<T>::EmplaceBack(Args&&... args) {
+inline T& Vector<T, Alloc, Growth>::EmplaceBack(Args&&... args) {
     return *Emplace(
         end(),
         std::forward<Args>(args)...);
 }
 
-template<typename T>
+template <typename T, typename Alloc, typename Growth>
 template<typename... Args>
-inline typename Vector<T>::iterator Vector<T>::Emplace(
-    typename Vector<T>::const_iterator pos, 
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::Emplace(
+    typename Vector<T, Alloc, Growth>::const_iterator pos, 
     Args&& ...args) {
     assert(pos >= begin() && pos <= end());     // <= end() because could be EmplaceBack()
     T* It = const_cast<T*>(pos);
     size_t dist = It - begin();
+    bool fits = data_.Capacity() > size_;
+    size_t new_capacity = 0;
+    if (!fits) {
+        new_capacity = GrowCapacity(size_ + 1);
+        fits = data_.TryExpand(new_capacity);
+    }
 
-    if (data_.Capacity() > size_) {
-        if (dist < size_) {
-            T tmp(std::forward<Args>(args)...);
-            new (&data_[size_]) T(std::move(data_[size_ - 1]));
-            std::move_backward(It, end() - 1, end());
-            data_[dist] = std::move(tmp);
+    if (fits) {
+        EmplaceIntoSpare(data_.GetAddress(), size_, dist, std::forward<Args>(args)...);
+    }
+    else if constexpr (is_trivially_relocatable_v<T>) {
+        // value is built before buffer moves: args may refer to an element
+        alignas(T) char slot[sizeof(T)];
+        T* value = new (slot) T(std::forward<Args>(args)...);
+        try {
+            Relocate(new_capacity);
         }
-        else {
-            new (&data_[size_]) T(std::forward<Args>(args)...);
+        catch (...) {
+            std::destroy_at(value);
+            throw;
         }
+        It = begin() + dist;
+        std::memmove(static_cast<void*>(It + 1), static_cast<const void*>(It),
+            (size_ - dist) * sizeof(T));
+        std::memcpy(static_cast<void*>(It), static_cast<const void*>(value), sizeof(T));
     }
     else {
-        size_t new_capacity = data_.Capacity() == 0 ? 1 : data_.Capacity() * 2;
-        RawMemory<T> tmp(new_capacity);
-
+        // new element is built first: args may refer to an element
+        RawMemory<T, Alloc> tmp(new_capacity, data_.GetAllocator());
         new (tmp + dist) T(std::forward<Args>(args)...);
-        if constexpr (
-            std::is_nothrow_move_constructible_v<T> ||
-            !std::is_copy_constructible_v<T>)
-        {
-            std::uninitialized_move_n(
-                data_.GetAddress(),
-                dist,
-                tmp.GetAddress());
-            std::uninitialized_move_n(
-                data_.GetAddress() + dist,
-                size_ - dist,
-                tmp.GetAddress() + dist + 1);
-        }
-        else {
-            std::uninitialized_copy_n(
-                data_.GetAddress(),
-                dist,
-                tmp.GetAddress());
-            std::uninitialized_copy_n(
-                data_.GetAddress() + dist,
-                size_ - dist,
-                tmp.GetAddress() + dist + 1);
-        }        
+        UninitializedRelocateAroundN(data_.GetAddress(), size_, dist, tmp.GetAddress());
         data_.Swap(tmp);
-        std::destroy_n(tmp.GetAddress(), tmp.Capacity());
     }
     ++size_;
     return data_.GetAddress() + dist;
 }
 
-template<typename T>
-inline void Vector<T>::PopBack() {
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::PopBack() {
     if (size_ == 0) {
         return;
     }
     --size_;
     std::destroy_n(data_.GetAddress() + size_, 1);
+    MaybeShrink();
 }
 
-template <typename T>
-const T& Vector<T>::operator[](size_t index) const noexcept {
+template <typename T, typename Alloc, typename Growth>
+const T& Vector<T, Alloc, Growth>::operator[](size_t index) const noexcept {
     return const_cast<Vector&>(*this)[index];
 }
 
-template <typename T>
-T& Vector<T>::operator[](size_t index) noexcept {
+template <typename T, typename Alloc, typename Growth>
+T& Vector<T, Alloc, Growth>::operator[](size_t index) noexcept {
     assert(index < size_);
     return data_[index];
 }
 
-template<typename T>
-inline Vector<T>& Vector<T>::operator=(const Vector& other) {
+template <typename T, typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth>& Vector<T, Alloc, Growth>::operator=(const Vector& other) {
     if (this != &other) {
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (data_.GetAllocator() != other.data_.GetAllocator()) {
+                // own buffer can't be reused - take copy with other's allocator
+                Vector other_copy(other, other.data_.GetAllocator());
+                data_.SwapAllocator(other_copy.data_);
+                data_.Swap(other_copy.data_);
+                std::swap(size_, other_copy.size_);
+                return *this;
+            }
+        }
         if (other.size_ > data_.Capacity()) {   // copy - swap
-            Vector<T> other_copy(other);
-            Swap(other_copy);
+            Vector other_copy(other, data_.GetAllocator());
+            data_.Swap(other_copy.data_);
+            std::swap(size_, other_copy.size_);
+        }
+        else if constexpr (std::is_trivially_copyable_v<T>) {
+            // one bulk copy, nothing to destroy
+            BulkCopy(data_.GetAddress(), other.data_.GetAddress(), other.size_ * sizeof(T));
+            size_ = other.size_;
         }
         else {
             if (size_ > other.size_) {
@@ -370,85 +1158,310 @@ inline Vector<T>& Vector<T>::operator=(const Vector& other) {
     return *this;
 }
 
-template<typename T>
-inline Vector<T>& Vector<T>::operator=(Vector&& other) noexcept {
-    Swap(other);
+template <typename T, typename Alloc, typename Growth>
+inline Vector<T, Alloc, Growth>& Vector<T, Alloc, Growth>::operator=(Vector&& other) noexcept(
+    AllocTraits::propagate_on_container_move_assignment::value ||
+    AllocTraits::is_always_equal::value) {
+    if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+        data_.SwapAllocator(other.data_);
+    }
+    else if constexpr (!AllocTraits::is_always_equal::value) {
+        if (data_.GetAllocator() != other.data_.GetAllocator()) {
+            // other's buffer can't be stolen - move elements one by one
+            Vector tmp(data_.GetAllocator());
+            tmp.Reserve(other.size_);
+            std::uninitialized_move_n(other.data_.GetAddress(), other.size_, tmp.data_.GetAddress());
+            tmp.size_ = other.size_;
+            data_.Swap(tmp.data_);
+            std::swap(size_, tmp.size_);
+            return *this;
+        }
+    }
+    // old elements and buffer are released here, not left in other
+    Clear();
+    data_.Swap(other.data_);
+    std::swap(size_, other.size_);
+    RawMemory<T, Alloc>(other.data_.GetAllocator()).Swap(other.data_);
     return *this;
 }
 
-template<typename T>
-inline void Vector<T>::DestroyN(T* buf, size_t n) noexcept {
+template <typename T, typename Alloc, typename Growth>
+inline size_t Vector<T, Alloc, Growth>::FindBit(const uint64_t* mask, size_t from, bool value) const noexcept {
+    if (from >= size_) {
+        return size_;
+    }
+    // words without wanted bit are skipped whole
+    const uint64_t flip = value ? 0 : ~uint64_t(0);
+    size_t word = from / 64;
+    uint64_t bits = (mask[word] ^ flip) & (~uint64_t(0) << (from % 64));
+    while (bits == 0) {
+        if (++word * 64 >= size_) {
+            return size_;
+        }
+        bits = mask[word] ^ flip;
+    }
+#if defined(__GNUC__)
+    size_t bit = static_cast<size_t>(__builtin_ctzll(bits));
+#else
+    size_t bit = 0;
+    while ((bits & 1) == 0) {
+        bits >>= 1;
+        ++bit;
+    }
+#endif
+    return std::min(size_, word * 64 + bit);
+}
+
+template <typename T, typename Alloc, typename Growth>
+template <typename ForwardIt>
+inline typename Vector<T, Alloc, Growth>::iterator Vector<T, Alloc, Growth>::InsertRange(
+    size_t dist, ForwardIt first, size_t count) {
+    if (count == 0) {
+        return begin() + dist;
+    }
+    if (size_ + count > data_.Capacity()) {
+        size_t new_capacity = GrowCapacity(size_ + count);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            // source range can't alias this vector, buffer may move freely
+            Reallocate(new_capacity);
+        }
+        else if (!data_.TryExpand(new_capacity)) {
+            RawMemory<T, Alloc> tmp(new_capacity, data_.GetAllocator());
+            UninitializedCopyRange(first, count, tmp + dist);
+            try {
+                UninitializedMoveIfNoexceptN(data_.GetAddress(), dist, tmp.GetAddress());
+                try {
+                    UninitializedMoveIfNoexceptN(data_.GetAddress() + dist, size_ - dist, tmp + (dist + count));
+                }
+                catch (...) {
+                    std::destroy_n(tmp.GetAddress(), dist);
+                    throw;
+                }
+            }
+            catch (...) {
+                std::destroy_n(tmp + dist, count);
+                throw;
+            }
+            std::destroy_n(data_.GetAddress(), size_);
+            data_.Swap(tmp);
+            size_ += count;
+            return begin() + dist;
+        }
+    }
+
+    T* It = begin() + dist;
+    size_t after = size_ - dist;
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::memmove(static_cast<void*>(It + count), static_cast<const void*>(It), after * sizeof(T));
+        try {
+            UninitializedCopyRange(first, count, It);
+        }
+        catch (...) {
+            std::memmove(static_cast<void*>(It), static_cast<const void*>(It + count), after * sizeof(T));
+            throw;
+        }
+        size_ += count;
+    }
+    else if (after > count) {
+        // size_ follows every constructed element: basic guarantee on exception
+        std::uninitialized_move_n(end() - count, count, end());
+        size_ += count;
+        std::move_backward(It, end() - 2 * count, end() - count);
+        for (size_t i = 0; i < count; ++i, ++first) {
+            It[i] = *first;
+        }
+    }
+    else {
+        ForwardIt mid = std::next(first, after);
+        UninitializedCopyRange(mid, count - after, end());
+        size_ += count - after;
+        std::uninitialized_move_n(It, after, end());
+        size_ += after;
+        std::copy(first, mid, It);
+    }
+    return begin() + dist;
+}
+
+template <typename T, typename Alloc, typename Growth>
+template <typename ForwardIt>
+inline void Vector<T, Alloc, Growth>::UninitializedCopyRange(ForwardIt first, size_t count, T* dst) {
+    if constexpr (
+        std::is_pointer_v<ForwardIt> &&
+        std::is_same_v<std::remove_cv_t<std::remove_pointer_t<ForwardIt>>, T> &&
+        std::is_trivially_copyable_v<T>)
+    {
+        // contiguous source
+        if (count != 0) {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(first), count * sizeof(T));
+        }
+    }
+    else {
+        std::uninitialized_copy_n(first, count, dst);
+    }
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::ShrinkTo(size_t new_capacity) {
+    assert(new_capacity >= size_ && new_capacity < data_.Capacity());
+    if (new_capacity == 0) {
+        RawMemory<T, Alloc>(data_.GetAllocator()).Swap(data_);
+        return;
+    }
+    // Reallocate takes smaller capacity as well: allocator hooks may shrink in place
+    Reallocate(new_capacity);
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::MaybeShrink() noexcept {
+    if constexpr (GrowthHasShrink<Growth>::value) {
+        size_t new_capacity = Growth::Shrink(data_.Capacity(), size_, sizeof(T));
+        if (new_capacity < data_.Capacity()) {
+            try {
+                ShrinkTo(std::max(new_capacity, size_));
+            }
+            catch (...) {
+                // elements are untouched, vector just keeps bigger buffer
+            }
+        }
+    }
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline size_t Vector<T, Alloc, Growth>::GrowCapacity(size_t required) const noexcept {
+    return GrowCapacityFor<Growth>(data_.GetAllocator(), data_.Capacity(), required, sizeof(T));
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::Reallocate(size_t new_capacity) {
+    if (data_.TryExpand(new_capacity)) {
+        return;
+    }
+    Relocate(new_capacity);
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::Relocate(size_t new_capacity) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+        if (data_.TryReallocate(new_capacity)) {
+            return;
+        }
+    }
+    RawMemory<T, Alloc> tmp(new_capacity, data_.GetAllocator());
+    UninitializedRelocateN(data_.GetAddress(), size_, tmp.GetAddress());
+    data_.Swap(tmp);
+}
+
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::DestroyN(T* buf, size_t n) noexcept {
     for (size_t i = 0; i < n; ++i) {
         Destroy(buf + i);
     }
 }
 
-template<typename T>
-inline void Vector<T>::Destroy(T* buf) noexcept {
+template <typename T, typename Alloc, typename Growth>
+inline void Vector<T, Alloc, Growth>::Destroy(T* buf) noexcept {
     buf->~T();
 }
 
-template<typename T>
-inline void RawMemory<T>::Swap(RawMemory& other) noexcept {
+template <typename T, typename Alloc>
+inline void RawMemory<T, Alloc>::Swap(RawMemory& other) noexcept {
     std::swap(buffer_, other.buffer_);
     std::swap(capacity_, other.capacity_);
 }
 
-template<typename T>
-inline const T* RawMemory<T>::GetAddress() const noexcept {
+template <typename T, typename Alloc>
+inline void RawMemory<T, Alloc>::SwapAllocator(RawMemory& other) noexcept {
+    using std::swap;
+    swap(alloc_, other.alloc_);
+}
+
+template <typename T, typename Alloc>
+inline bool RawMemory<T, Alloc>::TryExpand(size_t new_capacity) {
+    if constexpr (AllocatorHasExpand<Alloc, T>::value) {
+        if (buffer_ != nullptr && alloc_.expand(buffer_, capacity_, new_capacity)) {
+            capacity_ = new_capacity;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T, typename Alloc>
+inline bool RawMemory<T, Alloc>::TryReallocate(size_t new_capacity) {
+    static_assert(is_trivially_relocatable_v<T>);
+    if constexpr (AllocatorHasReallocate<Alloc, T>::value) {
+        if (buffer_ != nullptr) {
+            buffer_ = alloc_.reallocate(buffer_, capacity_, new_capacity);
+            capacity_ = new_capacity;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T, typename Alloc>
+inline const T* RawMemory<T, Alloc>::GetAddress() const noexcept {
     return buffer_;
 }
 
-template<typename T>
-inline T* RawMemory<T>::GetAddress() noexcept {
+template <typename T, typename Alloc>
+inline T* RawMemory<T, Alloc>::GetAddress() noexcept {
     return buffer_;
 }
 
-template<typename T>
-inline size_t RawMemory<T>::Capacity() const {
+template <typename T, typename Alloc>
+inline size_t RawMemory<T, Alloc>::Capacity() const {
     return capacity_;
 }
 
-template<typename T>
-inline T* RawMemory<T>::Allocate(size_t n) {
-    return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+template <typename T, typename Alloc>
+inline const Alloc& RawMemory<T, Alloc>::GetAllocator() const noexcept {
+    return alloc_;
 }
 
-template<typename T>
-inline void RawMemory<T>::Deallocate(T* buf) noexcept {
-    operator delete(buf);
+template <typename T, typename Alloc>
+inline T* RawMemory<T, Alloc>::Allocate(size_t n) {
+    return n != 0 ? std::allocator_traits<Alloc>::allocate(alloc_, n) : nullptr;
+}
+
+template <typename T, typename Alloc>
+inline void RawMemory<T, Alloc>::Deallocate(T* buf, size_t n) noexcept {
+    if (buf != nullptr) {
+        std::allocator_traits<Alloc>::deallocate(alloc_, buf, n);
+    }
 }
 
-template<typename T>
-inline T* RawMemory<T>::operator+(size_t offset) noexcept {
+template <typename T, typename Alloc>
+inline T* RawMemory<T, Alloc>::operator+(size_t offset) noexcept {
     // <= (not <) because .end() is out of allocated memory
     assert(offset <= capacity_);
     return buffer_ + offset;
 }
 
-template<typename T>
-inline const T* RawMemory<T>::operator+(size_t offset) const noexcept {
+template <typename T, typename Alloc>
+inline const T* RawMemory<T, Alloc>::operator+(size_t offset) const noexcept {
     return const_cast<RawMemory&>(*this) + offset;
 }
 
-template<typename T>
-inline const T& RawMemory<T>::operator[](size_t index) const noexcept {
+template <typename T, typename Alloc>
+inline const T& RawMemory<T, Alloc>::operator[](size_t index) const noexcept {
     return const_cast<RawMemory&>(*this)[index];
 }
 
-template<typename T>
-inline T& RawMemory<T>::operator[](size_t index) noexcept {
+template <typename T, typename Alloc>
+inline T& RawMemory<T, Alloc>::operator[](size_t index) noexcept {
     assert(index < capacity_);
     return buffer_[index];
 }
 
-template<typename T>
-inline RawMemory<T>& RawMemory<T>::operator=(RawMemory&& other) noexcept {
+template <typename T, typename Alloc>
+inline RawMemory<T, Alloc>& RawMemory<T, Alloc>::operator=(RawMemory&& other) noexcept {
     if (&other != this) {
-        buffer_ = std::move(other.buffer_);
-        capacity_ = std::move(other.capacity_);
-        other.buffer_ = nullptr;
-        other.capacity_ = 0;
+        // both buffers must come from equal allocators
+        assert(alloc_ == other.alloc_);
+        Deallocate(buffer_, capacity_);
+        buffer_ = std::exchange(other.buffer_, nullptr);
+        capacity_ = std::exchange(other.capacity_, 0);
     }
     return *this;
 }
\ No newline at end of file
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "vector.h"
+
+// binary file of trivially copyable elements, loaded without parsing or copying (POSIX only):
+//     WriteTo(fd, table);                          // header, padding, raw elements
+//     MappedVectorView<Row> rows("table.bin");     // mmap, pages shared between processes
+//     for (const Row& row : rows) ...
+// file layout: VectorFileHeader at offset 0, elements from header.data_offset;
+// files are read back on machines with same byte order, element size and alignment only
+struct VectorFileHeader {
+    static constexpr char MAGIC[8] = { 'S', 'V', 'E', 'C', 'T', 'O', 'R', '\0' };
+    static constexpr uint32_t VERSION = 1;
+    // reads as ORDER_MARK only on machines with byte order of writer
+    static constexpr uint32_t ORDER_MARK = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t element_size;
+    uint64_t element_align;
+    uint64_t count;
+    uint64_t data_offset;       // multiple of element_align
+    uint64_t checksum;          // VectorFileChecksum of elements
+};
+
+namespace detail {
+    inline constexpr uint64_t CHECKSUM_PRIME1 = 0x9E3779B185EBCA87ULL;
+    inline constexpr uint64_t CHECKSUM_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+
+    inline uint64_t RotateLeft(uint64_t x, int bits) noexcept {
+        return (x << bits) | (x >> (64 - bits));
+    }
+
+    // rotation carries every bit of word into low bits, multiply spreads them up
+    inline uint64_t ChecksumRound(uint64_t acc, uint64_t word) noexcept {
+        return RotateLeft(acc + word * CHECKSUM_PRIME2, 31) * CHECKSUM_PRIME1;
+    }
+
+    inline uint64_t LoadWord(const unsigned char* p) noexcept {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        return word;
+    }
+}  // namespace detail
+
+// 64-bit hash in the manner of xxHash64 (not compatible with it): four independent
+// accumulators over 32-byte stripes, then remaining 8-byte words, last partial word
+// zero-padded, and a final avalanche; any single bit of input reaches all bits of result
+inline uint64_t VectorFileChecksum(const void* data, size_t bytes) noexcept {
+    using namespace detail;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const uint64_t length = bytes;
+    uint64_t acc[4] = { CHECKSUM_PRIME1 + CHECKSUM_PRIME2, CHECKSUM_PRIME2, 0, 0 - CHECKSUM_PRIME1 };
+    for (; bytes >= 4 * sizeof(uint64_t); bytes -= 4 * sizeof(uint64_t), p += 4 * sizeof(uint64_t)) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            acc[lane] = ChecksumRound(acc[lane], LoadWord(p + lane * sizeof(uint64_t)));
+        }
+    }
+    uint64_t hash = RotateLeft(acc[0], 1) + RotateLeft(acc[1], 7) + RotateLeft(acc[2], 12) + RotateLeft(acc[3], 18);
+    for (uint64_t lane : acc) {
+        hash = (hash ^ ChecksumRound(0, lane)) * CHECKSUM_PRIME1 + CHECKSUM_PRIME2;
+    }
+    for (; bytes >= sizeof(uint64_t); bytes -= sizeof(uint64_t), p += sizeof(uint64_t)) {
+        hash = RotateLeft(hash ^ ChecksumRound(0, LoadWord(p)), 27) * CHECKSUM_PRIME1 + CHECKSUM_PRIME2;
+    }
+    if (bytes != 0) {
+        uint64_t word = 0;
+        std::memcpy(&word, p, bytes);
+        hash = RotateLeft(hash ^ ChecksumRound(0, word), 27) * CHECKSUM_PRIME1 + CHECKSUM_PRIME2;
+    }
+    hash ^= length;
+    hash ^= hash >> 33;
+    hash *= CHECKSUM_PRIME2;
+    hash ^= hash >> 29;
+    hash *= CHECKSUM_PRIME1;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+namespace detail {
+    inline void WriteAll(int fd, const void* data, size_t bytes) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes != 0) {
+            const ssize_t written = write(fd, p, bytes);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "WriteTo: write");
+            }
+            p += written;
+            bytes -= static_cast<size_t>(written);
+        }
+    }
+}  // namespace detail
+
+// writes count elements from data as whole file, fd is at start of empty file
+template <typename T>
+void WriteTo(int fd, const T* data, size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>, "WriteTo writes bytes of elements, T must be trivially copyable");
+    VectorFileHeader header{};
+    std::memcpy(header.magic, VectorFileHeader::MAGIC, sizeof(header.magic));
+    header.version = VectorFileHeader::VERSION;
+    header.byte_order = VectorFileHeader::ORDER_MARK;
+    header.element_size = sizeof(T);
+    header.element_align = alignof(T);
+    header.count = count;
+    header.data_offset = (sizeof(VectorFileHeader) + alignof(T) - 1) / alignof(T) * alignof(T);
+    header.checksum = VectorFileChecksum(data, count * sizeof(T));
+
+    detail::WriteAll(fd, &header, sizeof(header));
+    const char padding[alignof(T) > 1 ? alignof(T) : 1] = {};
+    detail::WriteAll(fd, padding, header.data_offset - sizeof(header));
+    detail::WriteAll(fd, data, count * sizeof(T));
+}
+
+template <typename T, typename Alloc, typename Growth>
+void WriteTo(int fd, const Vector<T, Alloc, Growth>& values) {
+    WriteTo(fd, values.begin(), values.Size());
+}
+
+// read-only elements of file written by WriteTo, mapped into memory;
+// header is checked on opening, VerifyChecksum() reads all elements
+template <typename T>
+class MappedVectorView {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVectorView reads bytes of elements, T must be trivially copyable");
+
+private:        // fields
+    void* mapping_ = nullptr;   // whole file, nullptr for empty view
+    size_t mapped_length_ = 0;
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+    uint64_t checksum_ = 0;
+
+public:         // constructors
+    MappedVectorView() = default;
+    explicit MappedVectorView(const std::string& path);
+    // fd stays open and owned by caller
+    explicit MappedVectorView(int fd);
+    MappedVectorView(const MappedVectorView&) = delete;
+    MappedVectorView(MappedVectorView&& other) noexcept;
+    ~MappedVectorView();
+
+public:         // iterators
+    using iterator = const T*;
+    using const_iterator = const T*;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+public:         // operators
+    const T& operator[](size_t index) const noexcept;
+
+    MappedVectorView& operator=(const MappedVectorView&) = delete;
+    MappedVectorView& operator=(MappedVectorView&& other) noexcept;
+
+public:         // methods
+    size_t Size() const noexcept;
+    const T* Data() const noexcept;
+    // compares elements with checksum of header
+    bool VerifyChecksum() const noexcept;
+    void Swap(MappedVectorView& other) noexcept;
+
+private:        // methods
+    void Map(int fd);
+    // throws std::runtime_error with reason, unmaps first
+    [[noreturn]] void Fail(const char* reason);
+};
+
+template <typename T>
+inline MappedVectorView<T>::MappedVectorView(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "MappedVectorView: open " + path);
+    }
+    try {
+        Map(fd);
+    }
+    catch (...) {
+        close(fd);
+        throw;
+    }
+    // mapping outlives descriptor
+    close(fd);
+}
+
+template <typename T>
+inline MappedVectorView<T>::MappedVectorView(int fd) {
+    Map(fd);
+}
+
+template <typename T>
+inline MappedVectorView<T>::MappedVectorView(MappedVectorView&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr))
+    , mapped_length_(std::exchange(other.mapped_length_, 0))
+    , data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0))
+    , checksum_(std::exchange(other.checksum_, 0)) {
+}
+
+template <typename T>
+inline MappedVectorView<T>::~MappedVectorView() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapped_length_);
+    }
+}
+
+template <typename T>
+inline typename MappedVectorView<T>::const_iterator MappedVectorView<T>::begin() const noexcept {
+    return data_;
+}
+
+template <typename T>
+inline typename MappedVectorView<T>::const_iterator MappedVectorView<T>::end() const noexcept {
+    return data_ + size_;
+}
+
+template <typename T>
+inline typename MappedVectorView<T>::const_iterator MappedVectorView<T>::cbegin() const noexcept {
+    return begin();
+}
+
+template <typename T>
+inline typename MappedVectorView<T>::const_iterator MappedVectorView<T>::cend() const noexcept {
+    return end();
+}
+
+template <typename T>
+inline const T& MappedVectorView<T>::operator[](size_t index) const noexcept {
+    assert(index < size_);
+    return data_[index];
+}
+
+template <typename T>
+inline MappedVectorView<T>& MappedVectorView<T>::operator=(MappedVectorView&& other) noexcept {
+    if (this != &other) {
+        MappedVectorView moved(std::move(other));
+        Swap(moved);
+    }
+    return *this;
+}
+
+template <typename T>
+inline size_t MappedVectorView<T>::Size() const noexcept {
+    return size_;
+}
+
+template <typename T>
+inline const T* MappedVectorView<T>::Data() const noexcept {
+    return data_;
+}
+
+template <typename T>
+inline bool MappedVectorView<T>::VerifyChecksum() const noexcept {
+    return VectorFileChecksum(data_, size_ * sizeof(T)) == checksum_;
+}
+
+template <typename T>
+inline void MappedVectorView<T>::Swap(MappedVectorView& other) noexcept {
+    std::swap(mapping_, other.mapping_);
+    std::swap(mapped_length_, other.mapped_length_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(checksum_, other.checksum_);
+}
+
+template <typename T>
+inline void MappedVectorView<T>::Map(int fd) {
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        throw std::system_error(errno, std::generic_category(), "MappedVectorView: fstat");
+    }
+    const size_t file_size = static_cast<size_t>(status.st_size);
+    if (file_size < sizeof(VectorFileHeader)) {
+        throw std::runtime_error("MappedVectorView: file is shorter than header");
+    }
+    void* p = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "MappedVectorView: mmap");
+    }
+    mapping_ = p;
+    mapped_length_ = file_size;
+
+    VectorFileHeader header;
+    std::memcpy(&header, mapping_, sizeof(header));
+    if (std::memcmp(header.magic, VectorFileHeader::MAGIC, sizeof(header.magic)) != 0) {
+        Fail("MappedVectorView: not a vector file");
+    }
+    if (header.version != VectorFileHeader::VERSION) {
+        Fail("MappedVectorView: unsupported version");
+    }
+    if (header.byte_order != VectorFileHeader::ORDER_MARK) {
+        Fail("MappedVectorView: file has other byte order");
+    }
+    if (header.element_size != sizeof(T) || header.element_align != alignof(T)) {
+        Fail("MappedVectorView: element size or alignment differs");
+    }
+    // mapping is page aligned, elements are aligned with offset
+    if (header.data_offset < sizeof(VectorFileHeader) || header.data_offset % alignof(T) != 0
+        || header.data_offset > file_size || header.count > (file_size - header.data_offset) / sizeof(T)) {
+        Fail("MappedVectorView: file is truncated or corrupted");
+    }
+    data_ = reinterpret_cast<const T*>(static_cast<const char*>(mapping_) + header.data_offset);
+    size_ = static_cast<size_t>(header.count);
+    checksum_ = header.checksum;
+}
+
+template <typename T>
+inline void MappedVectorView<T>::Fail(const char* reason) {
+    munmap(mapping_, mapped_length_);
+    mapping_ = nullptr;
+    mapped_length_ = 0;
+    throw std::runtime_error(reason);
+}
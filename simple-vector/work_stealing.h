@@ -0,0 +1,478 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+// Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli, PPoPP 2013):
+// owner thread pushes and pops at bottom (LIFO), other threads steal from top (FIFO)
+// ring grows by doubling, old rings are kept until destruction since thieves may still read them
+template <typename T>
+class ChaseLevDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "ChaseLevDeque stores trivially copyable items");
+
+private:        // types
+    struct Ring {
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Ring(size_t capacity);
+        size_t Capacity() const noexcept;
+        T Get(int64_t index) const noexcept;
+        void Put(int64_t index, T item) noexcept;
+    };
+
+private:        // fields
+    alignas(64) std::atomic<int64_t> top_{ 0 };
+    alignas(64) std::atomic<int64_t> bottom_{ 0 };
+    std::atomic<Ring*> ring_;
+    // every ring ever used, touched by owner only
+    Vector<std::unique_ptr<Ring>> rings_;
+
+public:         // constructors
+    // capacity must be power of two
+    explicit ChaseLevDeque(size_t capacity = 256);
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+public:         // methods
+    // owner only
+    void Push(T item);
+    // owner only, false if empty
+    bool Pop(T& item) noexcept;
+    // any thread, false if empty or lost race
+    bool Steal(T& item) noexcept;
+    bool Empty() const noexcept;
+};
+
+class WorkStealingScheduler;
+
+// fork/join group: Spawn() pushes task onto current worker's deque,
+// Sync() runs or steals tasks until every task of the group has finished
+//     TaskGroup group;
+//     group.Spawn([&] { left = Sum(first, middle); });
+//     right = Sum(middle, last);
+//     group.Sync();
+class TaskGroup {
+private:        // fields
+    WorkStealingScheduler& scheduler_;
+    std::atomic<size_t> pending_{ 0 };
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+
+public:         // constructors
+    explicit TaskGroup(WorkStealingScheduler& scheduler);
+    TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // waits for spawned tasks, their exceptions are lost
+    ~TaskGroup();
+
+public:         // methods
+    template <typename Function>
+    void Spawn(Function&& f);
+    // rethrows first exception of group's tasks
+    void Sync();
+
+private:        // methods
+    void Finish(std::exception_ptr error) noexcept;
+
+    friend class WorkStealingScheduler;
+};
+
+// workers with own Chase-Lev deques; idle worker steals from random victim,
+// then takes tasks spawned from outside threads, then sleeps for a short time
+class WorkStealingScheduler {
+private:        // types
+    struct Task {
+        TaskGroup* group = nullptr;
+
+        virtual ~Task() = default;
+        virtual void Run() = 0;
+    };
+
+    template <typename Function>
+    struct FunctionTask final : Task {
+        Function f;
+
+        explicit FunctionTask(Function&& function);
+        void Run() override;
+    };
+
+    // thread's place in a scheduler, workers only (thread_local - zero-initialized)
+    struct ThreadSlot {
+        WorkStealingScheduler* scheduler;
+        size_t index;
+        uint64_t random;
+    };
+
+private:        // fields
+    Vector<std::unique_ptr<ChaseLevDeque<Task*>>> deques_;
+    Vector<std::thread> threads_;
+    std::mutex injected_mutex_;
+    std::deque<Task*> injected_;
+    std::atomic<bool> stop_{ false };
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> sleeping_{ 0 };
+
+    static inline thread_local ThreadSlot current_;
+
+public:         // constructors
+    explicit WorkStealingScheduler(size_t threads);
+
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+    ~WorkStealingScheduler();
+
+public:         // methods
+    size_t Size() const noexcept;
+
+private:        // methods
+    template <typename Function>
+    void Spawn(TaskGroup& group, Function&& f);
+    // runs one task if it can find one
+    bool RunOne();
+    Task* FindTask() noexcept;
+    Task* StealTask(size_t skip) noexcept;
+    static void Execute(Task* task) noexcept;
+    void WorkerLoop(size_t index);
+    bool IsOwnWorker() const noexcept;
+
+    friend class TaskGroup;
+};
+
+// scheduler for TaskGroup() and ForkJoinFor: one worker per core
+WorkStealingScheduler& DefaultWorkStealingScheduler();
+
+namespace parallel {
+
+    // recursive halving of [first, last) down to grain elements, halves are spawned,
+    // so nested calls from body share all workers; body(chunk_first, chunk_last)
+    template <typename T, typename Body>
+    void ForkJoinFor(T* first, T* last, Body body, size_t grain = 1,
+        WorkStealingScheduler& scheduler = DefaultWorkStealingScheduler());
+
+}  // namespace parallel
+
+template <typename T>
+inline ChaseLevDeque<T>::Ring::Ring(size_t capacity)
+    : mask(capacity - 1)
+    , slots(new std::atomic<T>[capacity]) {
+    assert((capacity & mask) == 0);
+}
+
+template <typename T>
+inline size_t ChaseLevDeque<T>::Ring::Capacity() const noexcept {
+    return mask + 1;
+}
+
+template <typename T>
+inline T ChaseLevDeque<T>::Ring::Get(int64_t index) const noexcept {
+    return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+}
+
+template <typename T>
+inline void ChaseLevDeque<T>::Ring::Put(int64_t index, T item) noexcept {
+    slots[static_cast<size_t>(index) & mask].store(item, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline ChaseLevDeque<T>::ChaseLevDeque(size_t capacity) {
+    rings_.EmplaceBack(std::make_unique<Ring>(capacity));
+    ring_.store(rings_[0].get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+inline void ChaseLevDeque<T>::Push(T item) {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_acquire);
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    if (bottom - top >= static_cast<int64_t>(ring->Capacity())) {
+        auto grown = std::make_unique<Ring>(ring->Capacity() * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            grown->Put(i, ring->Get(i));
+        }
+        rings_.EmplaceBack(std::move(grown));
+        ring = rings_[rings_.Size() - 1].get();
+        ring_.store(ring, std::memory_order_release);
+    }
+    ring->Put(bottom, item);
+    bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+template <typename T>
+inline bool ChaseLevDeque<T>::Pop(T& item) noexcept {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    // seq_cst store / load pairs instead of the paper's fences (same ordering, visible to TSan)
+    bottom_.store(bottom, std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_seq_cst);
+    if (top > bottom) {
+        // was empty
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+    item = ring->Get(bottom);
+    if (top == bottom) {
+        // last item - race with thieves for it
+        bool won = top_.compare_exchange_strong(top, top + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+template <typename T>
+inline bool ChaseLevDeque<T>::Steal(T& item) noexcept {
+    int64_t top = top_.load(std::memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+    if (top >= bottom) {
+        return false;
+    }
+    Ring* ring = ring_.load(std::memory_order_acquire);
+    item = ring->Get(top);
+    return top_.compare_exchange_strong(top, top + 1,
+        std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline bool ChaseLevDeque<T>::Empty() const noexcept {
+    return top_.load(std::memory_order_acquire) >= bottom_.load(std::memory_order_acquire);
+}
+
+inline TaskGroup::TaskGroup(WorkStealingScheduler& scheduler)
+    : scheduler_(scheduler) { }
+
+inline TaskGroup::TaskGroup()
+    : TaskGroup(DefaultWorkStealingScheduler()) { }
+
+inline TaskGroup::~TaskGroup() {
+    try {
+        Sync();
+    }
+    catch (...) {
+    }
+}
+
+template <typename Function>
+inline void TaskGroup::Spawn(Function&& f) {
+    scheduler_.Spawn(*this, std::forward<Function>(f));
+}
+
+inline void TaskGroup::Sync() {
+    // help instead of blocking: nested groups can't starve workers
+    while (pending_.load(std::memory_order_acquire) != 0) {
+        if (!scheduler_.RunOne()) {
+            std::this_thread::yield();
+        }
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error = std::exchange(error_, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+inline void TaskGroup::Finish(std::exception_ptr error) noexcept {
+    if (error) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) {
+            error_ = error;
+        }
+    }
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+template <typename Function>
+inline WorkStealingScheduler::FunctionTask<Function>::FunctionTask(Function&& function)
+    : f(std::move(function)) { }
+
+template <typename Function>
+inline void WorkStealingScheduler::FunctionTask<Function>::Run() {
+    f();
+}
+
+inline WorkStealingScheduler::WorkStealingScheduler(size_t threads) {
+    deques_.Reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        deques_.EmplaceBack(std::make_unique<ChaseLevDeque<Task*>>());
+    }
+    threads_.Reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.EmplaceBack([this, i] { WorkerLoop(i); });
+    }
+}
+
+inline WorkStealingScheduler::~WorkStealingScheduler() {
+    stop_.store(true);
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+inline size_t WorkStealingScheduler::Size() const noexcept {
+    return threads_.Size();
+}
+
+template <typename Function>
+inline void WorkStealingScheduler::Spawn(TaskGroup& group, Function&& f) {
+    auto task = std::make_unique<FunctionTask<std::decay_t<Function>>>(std::decay_t<Function>(std::forward<Function>(f)));
+    task->group = &group;
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+    if (IsOwnWorker()) {
+        deques_[current_.index]->Push(task.release());
+    }
+    else {
+        std::lock_guard<std::mutex> lock(injected_mutex_);
+        injected_.push_back(task.release());
+    }
+    if (sleeping_.load(std::memory_order_acquire) != 0) {
+        wake_.notify_one();
+    }
+}
+
+inline bool WorkStealingScheduler::RunOne() {
+    Task* task = FindTask();
+    if (task == nullptr) {
+        return false;
+    }
+    Execute(task);
+    return true;
+}
+
+inline WorkStealingScheduler::Task* WorkStealingScheduler::FindTask() noexcept {
+    Task* task = nullptr;
+    size_t own = deques_.Size();
+    if (IsOwnWorker()) {
+        own = current_.index;
+        if (deques_[own]->Pop(task)) {
+            return task;
+        }
+    }
+    if ((task = StealTask(own)) != nullptr) {
+        return task;
+    }
+    std::lock_guard<std::mutex> lock(injected_mutex_);
+    if (!injected_.empty()) {
+        task = injected_.front();
+        injected_.pop_front();
+    }
+    return task;
+}
+
+inline WorkStealingScheduler::Task* WorkStealingScheduler::StealTask(size_t skip) noexcept {
+    const size_t count = deques_.Size();
+    if (count == 0) {
+        return nullptr;
+    }
+    // xorshift, victims are tried from a random start
+    uint64_t& random = current_.random;
+    if (random == 0) {
+        random = reinterpret_cast<uintptr_t>(&random) | 1;
+    }
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    const size_t start = static_cast<size_t>(random % count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t victim = (start + i) % count;
+        Task* task = nullptr;
+        if (victim != skip && deques_[victim]->Steal(task)) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+inline void WorkStealingScheduler::Execute(Task* task) noexcept {
+    std::unique_ptr<Task> owner(task);
+    std::exception_ptr error;
+    try {
+        task->Run();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+    TaskGroup* group = task->group;
+    owner.reset();
+    group->Finish(error);
+}
+
+inline void WorkStealingScheduler::WorkerLoop(size_t index) {
+    current_.scheduler = this;
+    current_.index = index;
+    const int SPINS = 64;
+    int idle = 0;
+    while (!stop_.load(std::memory_order_acquire)) {
+        if (RunOne()) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+        // short timed sleep: a missed wake-up costs at most one period
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleeping_.fetch_add(1, std::memory_order_acq_rel);
+        wake_.wait_for(lock, std::chrono::milliseconds(1));
+        sleeping_.fetch_sub(1, std::memory_order_acq_rel);
+        idle = 0;
+    }
+    current_ = ThreadSlot();
+}
+
+inline bool WorkStealingScheduler::IsOwnWorker() const noexcept {
+    return current_.scheduler == this;
+}
+
+inline WorkStealingScheduler& DefaultWorkStealingScheduler() {
+    static WorkStealingScheduler scheduler(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return scheduler;
+}
+
+namespace parallel {
+
+    template <typename T, typename Body>
+    inline void ForkJoinFor(T* first, T* last, Body body, size_t grain, WorkStealingScheduler& scheduler) {
+        grain = std::max(grain, size_t(1));
+        if (static_cast<size_t>(last - first) <= grain) {
+            if (first != last) {
+                body(first, last);
+            }
+            return;
+        }
+        T* middle = first + (last - first) / 2;
+        TaskGroup group(scheduler);
+        group.Spawn([=, &scheduler] { ForkJoinFor(first, middle, body, grain, scheduler); });
+        ForkJoinFor(middle, last, body, grain, scheduler);
+        group.Sync();
+    }
+
+}  // namespace parallel